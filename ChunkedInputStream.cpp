@@ -0,0 +1,26 @@
+#include "ChunkedInputStream.hpp"
+
+ChunkedInputStream::ChunkedInputStream(const TChunkReader& aChunkReader, std::size_t aChunkSize)
+    : mChunkReader(aChunkReader)
+    , mBuffer(aChunkSize)
+{
+}
+
+bool ChunkedInputStream::Fill()
+{
+    if (mFinished || !mChunkReader)
+    {
+        return false;
+    }
+
+    const std::size_t size = mChunkReader(mBuffer.data(), mBuffer.size());
+    if (size == 0)
+    {
+        mFinished = true;
+        return false;
+    }
+
+    mCurrent = mBuffer.data();
+    mEnd = mCurrent + size;
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <vector>
+
+/// Read-only rapidjson input stream over a body that arrives in chunks.
+/// The next chunk is pulled from the reader only when the current one is
+/// consumed, so parsing overlaps with the transfer and only one chunk is kept.
+class ChunkedInputStream
+{
+public:
+    using Ch = char;
+
+    /// Fills the buffer and returns the number of bytes written, 0 on end of body
+    using TChunkReader = std::function<std::size_t(char*, std::size_t)>;
+
+    static constexpr std::size_t DefaultChunkSize = 64 * 1024;
+
+    explicit ChunkedInputStream(
+        const TChunkReader& aChunkReader,
+        std::size_t aChunkSize = DefaultChunkSize);
+
+    Ch Peek()
+    {
+        if (mCurrent == mEnd && !Fill())
+        {
+            return '\0';
+        }
+        return *mCurrent;
+    }
+
+    Ch Take()
+    {
+        if (mCurrent == mEnd && !Fill())
+        {
+            return '\0';
+        }
+        ++mConsumed;
+        return *mCurrent++;
+    }
+
+    std::size_t Tell() const
+    {
+        return mConsumed;
+    }
+
+    // The stream is read-only, rapidjson calls these only for in-situ parsing
+    Ch* PutBegin()
+    {
+        assert(false);
+        return nullptr;
+    }
+
+    void Put(Ch)
+    {
+        assert(false);
+    }
+
+    void Flush()
+    {
+        assert(false);
+    }
+
+    std::size_t PutEnd(Ch*)
+    {
+        assert(false);
+        return 0;
+    }
+
+private:
+    bool Fill();
+
+    TChunkReader mChunkReader;
+
+    std::vector<char> mBuffer;
+    const char* mCurrent = nullptr;
+    const char* mEnd = nullptr;
+
+    std::size_t mConsumed = 0;
+    bool mFinished = false;
+};
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "CsvWriter.hpp"
+
+namespace
+{
+    /// Sign and 19 digits of int64
+    constexpr std::size_t MaxIntegerCharsLength = 20;
+}
+
+CsvWriter::CsvWriter(std::size_t aBufferSize)
+    : mBuffer(std::max<std::size_t>(aBufferSize, Money::MaxCharsLength + MaxIntegerCharsLength))
+{
+}
+
+CsvWriter::~CsvWriter()
+{
+    Close();
+}
+
+bool CsvWriter::Open(const std::string& aPath)
+{
+    Close();
+
+    mFile = std::fopen(aPath.c_str(), "wb");
+    if (!mFile)
+    {
+        std::cerr << "CsvWriter. Can't open " << aPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Whole buffers are written at once, the stdio buffer would only add a copy
+    std::setvbuf(mFile, nullptr, _IONBF, 0);
+    mSize = 0;
+    mHasError = false;
+    mIsRowStarted = false;
+    return true;
+}
+
+bool CsvWriter::IsOpen() const
+{
+    return mFile != nullptr;
+}
+
+void CsvWriter::WriteField(std::string_view aValue)
+{
+    BeginField();
+    if (aValue.empty())
+    {
+        aValue = "\"\"";
+    }
+
+    if (aValue.size() > mBuffer.size())
+    {
+        // Too long to be buffered, written as is after the pending data
+        Flush();
+        if (mFile && std::fwrite(aValue.data(), 1, aValue.size(), mFile) != aValue.size())
+        {
+            mHasError = true;
+        }
+        return;
+    }
+
+    std::memcpy(Reserve(aValue.size()), aValue.data(), aValue.size());
+    mSize += aValue.size();
+}
+
+void CsvWriter::WriteField(Money aValue)
+{
+    BeginField();
+    char* first = Reserve(Money::MaxCharsLength);
+    const auto result = aValue.ToChars(first, first + Money::MaxCharsLength);
+    mSize += static_cast<std::size_t>(result.ptr - first);
+}
+
+void CsvWriter::WriteField(std::int64_t aValue)
+{
+    BeginField();
+    char* first = Reserve(MaxIntegerCharsLength);
+    const auto result = std::to_chars(first, first + MaxIntegerCharsLength, aValue);
+    mSize += static_cast<std::size_t>(result.ptr - first);
+}
+
+void CsvWriter::WriteRow(const std::vector<std::string>& aFields)
+{
+    for (const auto& field : aFields)
+    {
+        WriteField(field);
+    }
+    EndRow();
+}
+
+void CsvWriter::EndRow()
+{
+    *Reserve(1) = '\n';
+    ++mSize;
+    mIsRowStarted = false;
+}
+
+bool CsvWriter::Flush()
+{
+    if (mSize != 0 && mFile)
+    {
+        if (std::fwrite(mBuffer.data(), 1, mSize, mFile) != mSize)
+        {
+            mHasError = true;
+        }
+    }
+    mSize = 0;
+    return !mHasError;
+}
+
+bool CsvWriter::Close()
+{
+    if (!mFile)
+    {
+        return !mHasError;
+    }
+
+    Flush();
+    if (std::fclose(mFile) != 0)
+    {
+        mHasError = true;
+    }
+    mFile = nullptr;
+
+    if (mHasError)
+    {
+        std::cerr << "CsvWriter. Write failed" << std::endl;
+    }
+    return !mHasError;
+}
+
+char* CsvWriter::Reserve(std::size_t aLength)
+{
+    if (mSize + aLength > mBuffer.size())
+    {
+        Flush();
+    }
+    return mBuffer.data() + mSize;
+}
+
+void CsvWriter::BeginField()
+{
+    if (mIsRowStarted)
+    {
+        *Reserve(1) = Delimiter;
+        ++mSize;
+    }
+    mIsRowStarted = true;
+}
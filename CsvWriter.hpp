@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Money.hpp"
+
+/// Buffered writer of ';' separated report files.
+/// Rows are formatted straight into one reusable buffer that is written out only when it is full,
+/// numbers go through std::to_chars, so a row costs no allocations and no flush.
+class CsvWriter
+{
+public:
+    static constexpr char Delimiter = ';';
+    static constexpr std::size_t DefaultBufferSize = 1 << 20;
+
+    explicit CsvWriter(std::size_t aBufferSize = DefaultBufferSize);
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    ~CsvWriter();
+
+    bool Open(const std::string& aPath);
+
+    bool IsOpen() const;
+
+    /// An empty value is written as "" to keep the column visible
+    void WriteField(std::string_view aValue);
+
+    void WriteField(Money aValue);
+
+    void WriteField(std::int64_t aValue);
+
+    void WriteRow(const std::vector<std::string>& aFields);
+
+    void EndRow();
+
+    /// Writes out the buffer, false if the file write failed
+    bool Flush();
+
+    /// Flushes and closes the file, false if any write failed
+    bool Close();
+
+private:
+    char* Reserve(std::size_t aLength);
+
+    void BeginField();
+
+    std::vector<char> mBuffer;
+    std::size_t mSize = 0;
+
+    std::FILE* mFile = nullptr;
+    bool mHasError = false;
+    bool mIsRowStarted = false;
+};
@@ -4,10 +4,21 @@ namespace TinkoffApi
 {
     struct MarketStocksResponse;
     struct OperationsResponse;
+    struct Operation;
+    struct OperationsViewBatch;
 }
 
 struct IParserHandler
 {
     virtual void OnMessageParsed(const TinkoffApi::MarketStocksResponse&) = 0;
     virtual void OnMessageParsed(const TinkoffApi::OperationsResponse&) = 0;
+
+    /// Views in the batch are valid only until the call returns
+    virtual void OnMessageParsed(const TinkoffApi::OperationsViewBatch&) = 0;
+
+    /// Called by the streaming parser for every operation as soon as it is read
+    virtual void OnOperationParsed(TinkoffApi::Operation&&) = 0;
+
+    /// Called by the streaming parser after the last operation of a response
+    virtual void OnOperationsParsed() = 0;
 };
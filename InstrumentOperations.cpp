@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cassert>
+
+#include "InstrumentOperations.hpp"
+
+namespace
+{
+    bool IdLess(const TinkoffApi::Operation& aLeft, const TinkoffApi::Operation& aRight)
+    {
+        return aLeft.numericId < aRight.numericId;
+    }
+}
+
+void InstrumentOperations::Append(TinkoffApi::Operation&& aOperation)
+{
+    mOperations.emplace_back(std::move(aOperation));
+}
+
+void InstrumentOperations::Merge()
+{
+    if (mSortedCount == mOperations.size())
+    {
+        return;
+    }
+
+    // Both steps are stable, so equal ids stay in arrival order and the last one is the newest
+    const auto middle = mOperations.begin() + static_cast<std::ptrdiff_t>(mSortedCount);
+    std::stable_sort(middle, mOperations.end(), IdLess);
+    std::inplace_merge(mOperations.begin(), middle, mOperations.end(), IdLess);
+
+    std::size_t writeIndex = 0;
+    for (std::size_t readIndex = 0; readIndex < mOperations.size(); ++readIndex)
+    {
+        const bool hasNewerCopy = readIndex + 1 < mOperations.size()
+            && mOperations[readIndex + 1].numericId == mOperations[readIndex].numericId;
+        if (hasNewerCopy)
+        {
+            continue;
+        }
+
+        if (writeIndex != readIndex)
+        {
+            mOperations[writeIndex] = std::move(mOperations[readIndex]);
+        }
+        ++writeIndex;
+    }
+
+    mOperations.erase(
+        mOperations.begin() + static_cast<std::ptrdiff_t>(writeIndex),
+        mOperations.end());
+    mSortedCount = mOperations.size();
+}
+
+const InstrumentOperations::TOperations& InstrumentOperations::GetOperations() const
+{
+    assert(mSortedCount == mOperations.size());
+    return mOperations;
+}
+
+bool InstrumentOperations::Empty() const
+{
+    return mOperations.empty();
+}
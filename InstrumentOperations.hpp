@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+
+#include "TinkoffApi.hpp"
+
+/// Operations of one instrument in a flat vector sorted by numeric id without duplicates.
+/// New operations are appended unsorted and merged into the sorted part in bulk.
+class InstrumentOperations
+{
+public:
+    using TOperations = std::pmr::vector<TinkoffApi::Operation>;
+
+    /// The operation is moved in, an arena allocated one is copied to the default resource
+    void Append(TinkoffApi::Operation&& aOperation);
+
+    /// Sorts the appended tail, merges it and keeps the latest copy of every id
+    void Merge();
+
+    /// Valid only after Merge
+    const TOperations& GetOperations() const;
+
+    bool Empty() const;
+
+private:
+    TOperations mOperations;
+    std::size_t mSortedCount = 0;
+};
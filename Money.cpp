@@ -0,0 +1,182 @@
+#include <limits>
+#include <ostream>
+
+#include "Money.hpp"
+
+bool Money::Parse(std::string_view aText, Money& outValue)
+{
+    std::size_t position = 0;
+
+    const bool isNegative = !aText.empty() && aText[0] == '-';
+    if (isNegative)
+    {
+        ++position;
+    }
+
+    // Significant digits without the decimal point and the point position among them
+    constexpr int maxDigits = 64;
+    char digits[maxDigits];
+    int digitsCount = 0;
+    int pointPosition = -1;
+
+    for (; position < aText.size(); ++position)
+    {
+        const char symbol = aText[position];
+        if (symbol >= '0' && symbol <= '9')
+        {
+            if (digitsCount < maxDigits)
+            {
+                digits[digitsCount++] = symbol;
+            }
+            else if (pointPosition < 0)
+            {
+                return false;
+            }
+        }
+        else if (symbol == '.' && pointPosition < 0)
+        {
+            pointPosition = digitsCount;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (digitsCount == 0)
+    {
+        return false;
+    }
+
+    if (pointPosition < 0)
+    {
+        pointPosition = digitsCount;
+    }
+
+    if (position < aText.size() && (aText[position] == 'e' || aText[position] == 'E'))
+    {
+        ++position;
+        if (position < aText.size() && aText[position] == '+')
+        {
+            ++position;
+        }
+
+        int exponent = 0;
+        const auto* first = aText.data() + position;
+        const auto* last = aText.data() + aText.size();
+        const auto [end, error] = std::from_chars(first, last, exponent);
+        if (error != std::errc() || end == first)
+        {
+            return false;
+        }
+        position = static_cast<std::size_t>(end - aText.data());
+        pointPosition += exponent;
+    }
+
+    if (position != aText.size())
+    {
+        return false;
+    }
+
+    constexpr auto maxUnits = std::numeric_limits<std::int64_t>::max();
+
+    std::int64_t units = 0;
+    for (int index = 0; index < pointPosition + Digits; ++index)
+    {
+        const int digit = index < digitsCount
+            ? digits[index] - '0'
+            : 0;
+
+        if (units > (maxUnits - digit) / 10)
+        {
+            return false;
+        }
+        units = units * 10 + digit;
+    }
+
+    outValue.mUnits = isNegative ? -units : units;
+    return true;
+}
+
+double Money::ToDouble() const
+{
+    return static_cast<double>(mUnits) / static_cast<double>(Scale);
+}
+
+std::to_chars_result Money::ToChars(char* aFirst, char* aLast) const
+{
+    char buffer[MaxCharsLength];
+    char* current = buffer + MaxCharsLength;
+
+    // Absolute value as unsigned to survive the minimal int64
+    std::uint64_t units = mUnits < 0
+        ? ~static_cast<std::uint64_t>(mUnits) + 1
+        : static_cast<std::uint64_t>(mUnits);
+
+    std::uint64_t fraction = units % Scale;
+    std::uint64_t integral = units / Scale;
+
+    if (fraction != 0)
+    {
+        int fractionDigits = Digits;
+        while (fraction % 10 == 0)
+        {
+            fraction /= 10;
+            --fractionDigits;
+        }
+
+        for (int index = 0; index < fractionDigits; ++index)
+        {
+            *--current = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        *--current = '.';
+    }
+
+    do
+    {
+        *--current = static_cast<char>('0' + integral % 10);
+        integral /= 10;
+    }
+    while (integral != 0);
+
+    if (mUnits < 0)
+    {
+        *--current = '-';
+    }
+
+    const auto length = static_cast<std::size_t>(buffer + MaxCharsLength - current);
+    if (static_cast<std::size_t>(aLast - aFirst) < length)
+    {
+        return {aLast, std::errc::value_too_large};
+    }
+
+    std::char_traits<char>::copy(aFirst, current, length);
+    return {aFirst + length, std::errc()};
+}
+
+std::string Money::ToString() const
+{
+    char buffer[MaxCharsLength];
+    const auto result = ToChars(buffer, buffer + MaxCharsLength);
+    return std::string(buffer, result.ptr);
+}
+
+bool ParseQuantity(std::string_view aText, Quantity& outValue)
+{
+    Money value;
+    if (!Money::Parse(aText, value) || value.GetUnits() % Money::Scale != 0)
+    {
+        return false;
+    }
+
+    outValue = value.GetUnits() / Money::Scale;
+    return true;
+}
+
+std::ostream& operator<<(std::ostream& outStream, Money aValue)
+{
+    char buffer[Money::MaxCharsLength];
+    const auto result = aValue.ToChars(buffer, buffer + Money::MaxCharsLength);
+    return outStream.write(buffer, result.ptr - buffer);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+/// Whole number of pieces or lots
+using Quantity = std::int64_t;
+
+/// Exact decimal amount stored as a 64-bit count of 10^-9 units,
+/// so sums over long histories are integer math without rounding.
+class Money
+{
+public:
+    static constexpr int Digits = 9;
+    static constexpr std::int64_t Scale = 1000000000;
+
+    /// Enough for the sign, 19 digits and the decimal point
+    static constexpr std::size_t MaxCharsLength = 21;
+
+    constexpr Money() = default;
+
+    static constexpr Money FromUnits(std::int64_t aUnits)
+    {
+        Money money;
+        money.mUnits = aUnits;
+        return money;
+    }
+
+    /// Parses JSON number text ("-12.345", "1e-3") without going through double.
+    /// Digits beyond 10^-9 are truncated, false on malformed text or overflow.
+    static bool Parse(std::string_view aText, Money& outValue);
+
+    constexpr std::int64_t GetUnits() const
+    {
+        return mUnits;
+    }
+
+    constexpr Money Abs() const
+    {
+        return FromUnits(mUnits < 0 ? -mUnits : mUnits);
+    }
+
+    double ToDouble() const;
+
+    /// Writes the shortest decimal form, like std::to_chars
+    std::to_chars_result ToChars(char* aFirst, char* aLast) const;
+
+    std::string ToString() const;
+
+    constexpr Money operator-() const
+    {
+        return FromUnits(-mUnits);
+    }
+
+    constexpr Money& operator+=(Money aOther)
+    {
+        mUnits += aOther.mUnits;
+        return *this;
+    }
+
+    constexpr Money& operator-=(Money aOther)
+    {
+        mUnits -= aOther.mUnits;
+        return *this;
+    }
+
+    friend constexpr Money operator+(Money aLeft, Money aRight)
+    {
+        return aLeft += aRight;
+    }
+
+    friend constexpr Money operator-(Money aLeft, Money aRight)
+    {
+        return aLeft -= aRight;
+    }
+
+    friend constexpr Money operator*(Money aPrice, Quantity aQuantity)
+    {
+        return FromUnits(aPrice.mUnits * aQuantity);
+    }
+
+    friend constexpr bool operator==(Money aLeft, Money aRight)
+    {
+        return aLeft.mUnits == aRight.mUnits;
+    }
+
+    friend constexpr bool operator!=(Money aLeft, Money aRight)
+    {
+        return aLeft.mUnits != aRight.mUnits;
+    }
+
+    friend constexpr bool operator<(Money aLeft, Money aRight)
+    {
+        return aLeft.mUnits < aRight.mUnits;
+    }
+
+    friend constexpr bool operator>(Money aLeft, Money aRight)
+    {
+        return aLeft.mUnits > aRight.mUnits;
+    }
+
+private:
+    std::int64_t mUnits = 0;
+};
+
+/// Accepts integral text only ("10", "10.0", "1e1")
+bool ParseQuantity(std::string_view aText, Quantity& outValue);
+
+std::ostream& operator<<(std::ostream& outStream, Money aValue);
@@ -0,0 +1,406 @@
+#include <map>
+
+#include "OperationsSaxHandler.hpp"
+
+OperationsSaxHandler::OperationsSaxHandler(SymbolTable& aSymbols, const TOperationCallback& aCallback)
+    : mSymbols(aSymbols)
+    , mCallback(aCallback)
+{
+}
+
+bool OperationsSaxHandler::Null()
+{
+    return true;
+}
+
+bool OperationsSaxHandler::Bool(bool aValue)
+{
+    if (Skip())
+    {
+        return true;
+    }
+
+    if (mState == State::Operation && mField == Field::IsMarginCall)
+    {
+        mOperation.isMarginCall = aValue;
+    }
+    return true;
+}
+
+bool OperationsSaxHandler::RawNumber(const char* aValue, rapidjson::SizeType aLength, bool)
+{
+    return OnNumber({aValue, aLength});
+}
+
+bool OperationsSaxHandler::String(const char* aValue, rapidjson::SizeType aLength, bool)
+{
+    if (Skip())
+    {
+        return true;
+    }
+
+    std::pmr::string* target = nullptr;
+
+    if (mState == State::Root)
+    {
+        if (mField == Field::TrackingId)
+        {
+            target = &mTrackingId;
+        }
+        else if (mField == Field::Status)
+        {
+            target = &mStatus;
+        }
+    }
+    else if (mState == State::Operation)
+    {
+        if (mField == Field::Id)
+        {
+            target = &mOperation.id;
+        }
+        else if (mField == Field::Status)
+        {
+            mOperation.status = TinkoffApi::ParseOperationStatus({aValue, aLength});
+        }
+        else if (mField == Field::OperationType)
+        {
+            mOperation.operationType = TinkoffApi::ParseOperationType({aValue, aLength});
+        }
+        else if (mField == Field::Figi)
+        {
+            target = &mOperation.figi;
+        }
+        else if (mField == Field::InstrumentType)
+        {
+            mOperation.instrumentType = TinkoffApi::ParseInstrumentType({aValue, aLength});
+        }
+        else if (mField == Field::Currency)
+        {
+            target = &mOperation.currency;
+        }
+        else if (mField == Field::Date)
+        {
+            target = &mOperation.date;
+        }
+    }
+    else if (mState == State::Commission)
+    {
+        if (mField == Field::Currency)
+        {
+            target = &mOperation.commission.currency;
+        }
+    }
+    else if (mState == State::Trade)
+    {
+        if (mField == Field::TradeId)
+        {
+            target = &mTrade.tradeId;
+        }
+        else if (mField == Field::Date)
+        {
+            target = &mTrade.date;
+        }
+    }
+
+    if (target)
+    {
+        target->assign(aValue, aLength);
+    }
+    return true;
+}
+
+bool OperationsSaxHandler::StartObject()
+{
+    if (Skip())
+    {
+        ++mSkipDepth;
+        return true;
+    }
+
+    if (mState == State::Start)
+    {
+        mState = State::Root;
+    }
+    else if (mState == State::Root && mField == Field::Payload)
+    {
+        mState = State::Payload;
+    }
+    else if (mState == State::Operations)
+    {
+        mOperation = TinkoffApi::Operation{};
+        mState = State::Operation;
+    }
+    else if (mState == State::Operation && mField == Field::Commission)
+    {
+        mState = State::Commission;
+    }
+    else if (mState == State::Trades)
+    {
+        mTrade = TinkoffApi::Trade{};
+        mState = State::Trade;
+    }
+    else
+    {
+        mSkipDepth = 1;
+    }
+    return true;
+}
+
+bool OperationsSaxHandler::Key(const char* aKey, rapidjson::SizeType aLength, bool)
+{
+    if (Skip())
+    {
+        return true;
+    }
+
+    mKey.assign(aKey, aLength);
+    mField = GetField(mState, mKey);
+    return true;
+}
+
+bool OperationsSaxHandler::EndObject(rapidjson::SizeType)
+{
+    if (Skip())
+    {
+        --mSkipDepth;
+        return true;
+    }
+
+    switch (mState)
+    {
+    case State::Trade:
+        mOperation.trades.emplace_back(std::move(mTrade));
+        mState = State::Trades;
+        break;
+    case State::Commission:
+        mState = State::Operation;
+        break;
+    case State::Operation:
+        mOperation.numericId = TinkoffApi::ParseOperationId(mOperation.id);
+        mOperation.figiId = mSymbols.Intern(mOperation.figi);
+        mOperation.currencyId = mSymbols.Intern(mOperation.currency);
+        ++mOperationsCount;
+        if (mCallback)
+        {
+            // mOperation is reset on the next operation, so it is handed over
+            mCallback(std::move(mOperation));
+        }
+        mState = State::Operations;
+        break;
+    case State::Payload:
+        mState = State::Root;
+        break;
+    case State::Root:
+        mState = State::Finished;
+        break;
+    case State::Start:
+    case State::Operations:
+    case State::Trades:
+    case State::Finished:
+        return false;
+    }
+    mField = Field::Unknown;
+    return true;
+}
+
+bool OperationsSaxHandler::StartArray()
+{
+    if (Skip())
+    {
+        ++mSkipDepth;
+        return true;
+    }
+
+    if (mState == State::Payload && mField == Field::Operations)
+    {
+        mState = State::Operations;
+    }
+    else if (mState == State::Operation && mField == Field::Trades)
+    {
+        mState = State::Trades;
+    }
+    else
+    {
+        mSkipDepth = 1;
+    }
+    return true;
+}
+
+bool OperationsSaxHandler::EndArray(rapidjson::SizeType)
+{
+    if (Skip())
+    {
+        --mSkipDepth;
+        return true;
+    }
+
+    if (mState == State::Trades)
+    {
+        mState = State::Operation;
+    }
+    else if (mState == State::Operations)
+    {
+        mState = State::Payload;
+    }
+    else
+    {
+        return false;
+    }
+    mField = Field::Unknown;
+    return true;
+}
+
+const std::pmr::string& OperationsSaxHandler::GetTrackingId() const
+{
+    return mTrackingId;
+}
+
+const std::pmr::string& OperationsSaxHandler::GetStatus() const
+{
+    return mStatus;
+}
+
+std::size_t OperationsSaxHandler::GetOperationsCount() const
+{
+    return mOperationsCount;
+}
+
+OperationsSaxHandler::Field OperationsSaxHandler::GetField(State aState, const std::string& aKey)
+{
+    using TFields = std::map<std::string, Field>;
+
+    static const TFields rootFields
+    {
+        {"trackingId", Field::TrackingId},
+        {"status", Field::Status},
+        {"payload", Field::Payload}
+    };
+
+    static const TFields payloadFields
+    {
+        {"operations", Field::Operations}
+    };
+
+    static const TFields operationFields
+    {
+        {"id", Field::Id},
+        {"status", Field::Status},
+        {"operationType", Field::OperationType},
+        {"figi", Field::Figi},
+        {"instrumentType", Field::InstrumentType},
+        {"price", Field::Price},
+        {"quantity", Field::Amount},
+        {"currency", Field::Currency},
+        {"date", Field::Date},
+        {"payment", Field::Payment},
+        {"isMarginCall", Field::IsMarginCall},
+        {"commission", Field::Commission},
+        {"trades", Field::Trades}
+    };
+
+    static const TFields commissionFields
+    {
+        {"currency", Field::Currency},
+        {"value", Field::Value}
+    };
+
+    static const TFields tradeFields
+    {
+        {"tradeId", Field::TradeId},
+        {"date", Field::Date},
+        {"price", Field::Price},
+        {"quantity", Field::Amount}
+    };
+
+    const TFields* fields = nullptr;
+
+    switch (aState)
+    {
+    case State::Root:
+        fields = &rootFields;
+        break;
+    case State::Payload:
+        fields = &payloadFields;
+        break;
+    case State::Operation:
+        fields = &operationFields;
+        break;
+    case State::Commission:
+        fields = &commissionFields;
+        break;
+    case State::Trade:
+        fields = &tradeFields;
+        break;
+    case State::Start:
+    case State::Operations:
+    case State::Trades:
+    case State::Finished:
+        return Field::Unknown;
+    }
+
+    const auto it = fields->find(aKey);
+    return it != fields->end()
+        ? it->second
+        : Field::Unknown;
+}
+
+bool OperationsSaxHandler::OnNumber(std::string_view aValue)
+{
+    if (Skip())
+    {
+        return true;
+    }
+
+    Money* money = nullptr;
+    Quantity* quantity = nullptr;
+
+    if (mState == State::Operation)
+    {
+        if (mField == Field::Price)
+        {
+            money = &mOperation.price;
+        }
+        else if (mField == Field::Amount)
+        {
+            quantity = &mOperation.quantity;
+        }
+        else if (mField == Field::Payment)
+        {
+            money = &mOperation.payment;
+        }
+    }
+    else if (mState == State::Commission)
+    {
+        if (mField == Field::Value)
+        {
+            money = &mOperation.commission.value;
+        }
+    }
+    else if (mState == State::Trade)
+    {
+        if (mField == Field::Price)
+        {
+            money = &mTrade.price;
+        }
+        else if (mField == Field::Amount)
+        {
+            quantity = &mTrade.quantity;
+        }
+    }
+
+    // A malformed number stops the parsing as a handler error
+    if (money)
+    {
+        return Money::Parse(aValue, *money);
+    }
+    if (quantity)
+    {
+        return ParseQuantity(aValue, *quantity);
+    }
+    return true;
+}
+
+bool OperationsSaxHandler::Skip()
+{
+    return mSkipDepth > 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <functional>
+
+#include <rapidjson/reader.h>
+
+#include "SymbolTable.hpp"
+#include "TinkoffApi.hpp"
+
+/// SAX handler for /openapi/operations responses.
+/// Fills TinkoffApi::Operation straight from the token stream and reports
+/// every operation as soon as its closing brace is read, so no DOM is built.
+/// Prices are parsed from the number text straight into Money.
+class OperationsSaxHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, OperationsSaxHandler>
+{
+public:
+    using TOperationCallback = std::function<void(TinkoffApi::Operation&&)>;
+
+    OperationsSaxHandler(SymbolTable& aSymbols, const TOperationCallback& aCallback);
+
+    bool Null();
+    bool Bool(bool aValue);
+    /// Numbers arrive as text, the handler must be used with kParseNumbersAsStringsFlag
+    bool RawNumber(const char* aValue, rapidjson::SizeType aLength, bool aCopy);
+    bool String(const char* aValue, rapidjson::SizeType aLength, bool aCopy);
+    bool StartObject();
+    bool Key(const char* aKey, rapidjson::SizeType aLength, bool aCopy);
+    bool EndObject(rapidjson::SizeType aMemberCount);
+    bool StartArray();
+    bool EndArray(rapidjson::SizeType aElementCount);
+
+    const std::pmr::string& GetTrackingId() const;
+
+    const std::pmr::string& GetStatus() const;
+
+    std::size_t GetOperationsCount() const;
+
+private:
+    enum class State
+    {
+        Start,
+        Root,
+        Payload,
+        Operations,
+        Operation,
+        Commission,
+        Trades,
+        Trade,
+        Finished
+    };
+
+    enum class Field
+    {
+        Unknown,
+        TrackingId,
+        Status,
+        Payload,
+        Operations,
+        Id,
+        OperationType,
+        Figi,
+        InstrumentType,
+        Price,
+        Amount,
+        Currency,
+        Date,
+        Payment,
+        IsMarginCall,
+        Commission,
+        Trades,
+        TradeId,
+        Value
+    };
+
+    static Field GetField(State aState, const std::string& aKey);
+
+    bool OnNumber(std::string_view aValue);
+
+    bool Skip();
+
+    SymbolTable& mSymbols;
+
+    TOperationCallback mCallback;
+
+    State mState = State::Start;
+    Field mField = Field::Unknown;
+    std::size_t mSkipDepth = 0;
+
+    std::string mKey;
+    std::pmr::string mTrackingId;
+    std::pmr::string mStatus;
+    std::size_t mOperationsCount = 0;
+
+    TinkoffApi::Operation mOperation;
+    TinkoffApi::Trade mTrade;
+};
@@ -5,15 +5,88 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include "OperationsSaxHandler.hpp"
 #include "Parser.hpp"
 
-JsonParser::JsonParser(const std::shared_ptr<IParserHandler>& aProcessor)
-    : mParserHander(aProcessor)
+namespace
+{
+    /// Numbers are kept as text and converted to Money without going through double
+    constexpr unsigned ParseFlags = rapidjson::kParseNumbersAsStringsFlag;
+
+    std::string_view GetStringView(const rapidjson::Value& aValue)
+    {
+        return {aValue.GetString(), aValue.GetStringLength()};
+    }
+
+    Money GetMoney(const rapidjson::Value& aValue)
+    {
+        Money money;
+        if (!aValue.IsString() || !Money::Parse(GetStringView(aValue), money))
+        {
+            std::cerr << "Invalid money value" << std::endl;
+        }
+        return money;
+    }
+
+    Quantity GetQuantity(const rapidjson::Value& aValue)
+    {
+        Quantity quantity = 0;
+        if (!aValue.IsString() || !ParseQuantity(GetStringView(aValue), quantity))
+        {
+            std::cerr << "Invalid quantity value" << std::endl;
+        }
+        return quantity;
+    }
+
+    /// Releases the arena in one shot when the parsed response is consumed
+    struct ArenaGuard
+    {
+        explicit ArenaGuard(std::pmr::monotonic_buffer_resource& aArena)
+            : mArena(aArena)
+        {
+        }
+
+        ~ArenaGuard()
+        {
+            mArena.release();
+        }
+
+        std::pmr::monotonic_buffer_resource& mArena;
+    };
+}
+
+JsonParser::JsonParser(
+    const std::shared_ptr<IParserHandler>& aProcessor,
+    const std::shared_ptr<SymbolTable>& aSymbols,
+    ParseMode aParseMode)
+    : mDocumentBuffer(DocumentChunkSize)
+    , mDocumentAllocator(mDocumentBuffer.data(), mDocumentBuffer.size(), DocumentChunkSize)
+    , mDocument(&mDocumentAllocator)
+    , mArena(ArenaChunkSize)
+    , mParserHander(aProcessor)
+    , mSymbols(aSymbols)
+    , mParseMode(aParseMode)
 {
 }
 
 void JsonParser::Parse(const std::string& aJsonString, TinkoffApi::ResponseType aResponseType)
 {
+    // Operations are the only large responses, the DOM path stays as a fallback for them
+    if (aResponseType == TinkoffApi::ResponseType::OperationsResponse
+        && mParseMode == ParseMode::Sax)
+    {
+        rapidjson::StringStream stream(aJsonString.c_str());
+        ParseOperationsSax(stream);
+        return;
+    }
+
+    if (aResponseType == TinkoffApi::ResponseType::OperationsResponse
+        && mParseMode == ParseMode::Insitu)
+    {
+        ParseOperationsInsitu(aJsonString);
+        return;
+    }
+
     std::string outError;
     if (!CheckJsonScheme(aJsonString, outError))
     {
@@ -21,6 +94,34 @@ void JsonParser::Parse(const std::string& aJsonString, TinkoffApi::ResponseType
         return;
     }
 
+    ParseDocument(aResponseType);
+}
+
+void JsonParser::ParseStream(ChunkedInputStream& aStream, TinkoffApi::ResponseType aResponseType)
+{
+    // A chunked body can't be parsed in situ, so the insitu mode streams through SAX too
+    if (aResponseType == TinkoffApi::ResponseType::OperationsResponse
+        && mParseMode != ParseMode::Dom)
+    {
+        ParseOperationsSax(aStream);
+        return;
+    }
+
+    ResetDocument();
+    mDocument.ParseStream<ParseFlags>(aStream);
+
+    if (mDocument.HasParseError())
+    {
+        std::cerr << "Json parsing error: " << rapidjson::GetParseError_En(mDocument.GetParseError())
+            << ", offset " << mDocument.GetErrorOffset() << std::endl;
+        return;
+    }
+
+    ParseDocument(aResponseType);
+}
+
+void JsonParser::ParseDocument(TinkoffApi::ResponseType aResponseType)
+{
     switch (aResponseType)
     {
     case TinkoffApi::ResponseType::PortfolioResponse:
@@ -71,7 +172,9 @@ void JsonParser::ParsePortfolio()
 
 void JsonParser::ParseOperations()
 {
-    TinkoffApi::OperationsResponse operationsResponse;
+    // Declared first so the arena outlives the response built on it
+    const ArenaGuard arenaGuard(mArena);
+    TinkoffApi::OperationsResponse operationsResponse(&mArena);
 
     if (!mDocument.HasMember("payload"))
     {
@@ -87,49 +190,53 @@ void JsonParser::ParseOperations()
     }
 
     const auto& operations = payload["operations"].GetArray();
+    operationsResponse.operations.reserve(operations.Size());
 
     for (const auto& operationObj : operations)
     {
-        TinkoffApi::Operation operation;
+        auto& operation = operationsResponse.operations.emplace_back();
 
         if (CheckExist(operationObj, "id"))
         {
             operation.id = operationObj["id"].GetString();
+            operation.numericId = TinkoffApi::ParseOperationId(operation.id);
         }
 
         if (CheckExist(operationObj, "status"))
         {
-            operation.status = operationObj["status"].GetString();
+            operation.status = TinkoffApi::ParseOperationStatus(GetStringView(operationObj["status"]));
         }
 
         if (CheckExist(operationObj, "operationType"))
         {
-            operation.operationType = operationObj["operationType"].GetString();
+            operation.operationType = TinkoffApi::ParseOperationType(GetStringView(operationObj["operationType"]));
         }
 
         if (CheckExist(operationObj, "figi"))
         {
             operation.figi = operationObj["figi"].GetString();
+            operation.figiId = mSymbols->Intern(operation.figi);
         }
 
         if (CheckExist(operationObj, "instrumentType"))
         {
-            operation.instrumentType = operationObj["instrumentType"].GetString();
+            operation.instrumentType = TinkoffApi::ParseInstrumentType(GetStringView(operationObj["instrumentType"]));
         }
 
         if (CheckExist(operationObj, "price"))
         {
-            operation.price = operationObj["price"].GetDouble();
+            operation.price = GetMoney(operationObj["price"]);
         }
 
         if (CheckExist(operationObj, "quantity"))
         {
-            operation.quantity = operationObj["quantity"].GetDouble();
+            operation.quantity = GetQuantity(operationObj["quantity"]);
         }
 
         if (CheckExist(operationObj, "currency"))
         {
             operation.currency = operationObj["currency"].GetString();
+            operation.currencyId = mSymbols->Intern(operation.currency);
         }
 
         if (CheckExist(operationObj, "date"))
@@ -139,33 +246,31 @@ void JsonParser::ParseOperations()
 
         if (CheckExist(operationObj, "payment"))
         {
-            operation.payment = operationObj["payment"].GetDouble();
+            operation.payment = GetMoney(operationObj["payment"]);
         }
 
         if (CheckExist(operationObj, "commission"))
         {
             const auto& commission = operationObj["commission"];
             operation.commission.currency = commission["currency"].GetString();
-            operation.commission.value = commission["value"].GetDouble();
+            operation.commission.value = GetMoney(commission["value"]);
         }
 
         if (!CheckExist(operationObj, "trades"))
         {
-            operationsResponse.operations.emplace_back(operation);
             continue;
         }
 
         const auto& trades = operationObj["trades"].GetArray();
+        operation.trades.reserve(trades.Size());
         for (const auto& tradeObj : trades)
         {
-            TinkoffApi::Trade trade;
+            auto& trade = operation.trades.emplace_back();
             trade.tradeId = tradeObj["tradeId"].GetString();
             trade.date = tradeObj["date"].GetString();
-            trade.price = tradeObj["price"].GetDouble();
-            trade.quantity = tradeObj["quantity"].GetDouble();
-            operation.trades.emplace_back(trade);
+            trade.price = GetMoney(tradeObj["price"]);
+            trade.quantity = GetQuantity(tradeObj["quantity"]);
         }
-        operationsResponse.operations.emplace_back(operation);
     }
 
     if (mParserHander)
@@ -174,6 +279,158 @@ void JsonParser::ParseOperations()
     }
 }
 
+template <typename TInputStream>
+void JsonParser::ParseOperationsSax(TInputStream& aStream)
+{
+    OperationsSaxHandler handler(
+        *mSymbols,
+        [this](TinkoffApi::Operation&& aOperation)
+        {
+            if (mParserHander)
+            {
+                mParserHander->OnOperationParsed(std::move(aOperation));
+            }
+        });
+
+    rapidjson::Reader reader;
+
+    const auto result = reader.Parse<ParseFlags>(aStream, handler);
+    if (result.IsError())
+    {
+        std::cerr << "Json parsing error: " << rapidjson::GetParseError_En(result.Code())
+            << ", offset " << result.Offset()
+            << ", operations parsed " << handler.GetOperationsCount() << std::endl;
+    }
+
+    // Operations parsed before an error are still delivered, so the handler is always notified
+    if (mParserHander)
+    {
+        mParserHander->OnOperationsParsed();
+    }
+}
+
+void JsonParser::ParseOperationsInsitu(const std::string& aJsonString)
+{
+    TinkoffApi::OperationsViewBatch batch;
+    batch.body.reserve(aJsonString.size() + 1);
+    batch.body.assign(aJsonString.begin(), aJsonString.end());
+    batch.body.push_back('\0');
+
+    ResetDocument();
+    mDocument.ParseInsitu<ParseFlags>(batch.body.data());
+
+    if (mDocument.HasParseError())
+    {
+        std::cerr << "Json parsing error: " << rapidjson::GetParseError_En(mDocument.GetParseError())
+            << ", offset " << mDocument.GetErrorOffset() << std::endl;
+        return;
+    }
+
+    if (!mDocument.HasMember("payload"))
+    {
+        std::cerr << "no payload" << std::endl;
+        return;
+    }
+
+    auto& payload = mDocument["payload"];
+
+    if (!CheckExist(payload, "operations"))
+    {
+        return;
+    }
+
+    const auto& operations = payload["operations"].GetArray();
+    batch.operations.reserve(operations.Size());
+
+    for (const auto& operationObj : operations)
+    {
+        TinkoffApi::OperationView operation;
+
+        if (CheckExist(operationObj, "id"))
+        {
+            operation.id = GetStringView(operationObj["id"]);
+            operation.numericId = TinkoffApi::ParseOperationId(operation.id);
+        }
+
+        if (CheckExist(operationObj, "status"))
+        {
+            operation.status = TinkoffApi::ParseOperationStatus(GetStringView(operationObj["status"]));
+        }
+
+        if (CheckExist(operationObj, "operationType"))
+        {
+            operation.operationType = TinkoffApi::ParseOperationType(GetStringView(operationObj["operationType"]));
+        }
+
+        if (CheckExist(operationObj, "figi"))
+        {
+            operation.figi = GetStringView(operationObj["figi"]);
+            operation.figiId = mSymbols->Intern(operation.figi);
+        }
+
+        if (CheckExist(operationObj, "instrumentType"))
+        {
+            operation.instrumentType = TinkoffApi::ParseInstrumentType(GetStringView(operationObj["instrumentType"]));
+        }
+
+        if (CheckExist(operationObj, "price"))
+        {
+            operation.price = GetMoney(operationObj["price"]);
+        }
+
+        if (CheckExist(operationObj, "quantity"))
+        {
+            operation.quantity = GetQuantity(operationObj["quantity"]);
+        }
+
+        if (CheckExist(operationObj, "currency"))
+        {
+            operation.currency = GetStringView(operationObj["currency"]);
+            operation.currencyId = mSymbols->Intern(operation.currency);
+        }
+
+        if (CheckExist(operationObj, "date"))
+        {
+            operation.date = GetStringView(operationObj["date"]);
+        }
+
+        if (CheckExist(operationObj, "payment"))
+        {
+            operation.payment = GetMoney(operationObj["payment"]);
+        }
+
+        if (CheckExist(operationObj, "commission"))
+        {
+            const auto& commission = operationObj["commission"];
+            operation.commission.currency = GetStringView(commission["currency"]);
+            operation.commission.value = GetMoney(commission["value"]);
+        }
+
+        operation.firstTrade = batch.trades.size();
+
+        if (CheckExist(operationObj, "trades"))
+        {
+            for (const auto& tradeObj : operationObj["trades"].GetArray())
+            {
+                TinkoffApi::TradeView trade;
+                trade.tradeId = GetStringView(tradeObj["tradeId"]);
+                trade.date = GetStringView(tradeObj["date"]);
+                trade.price = GetMoney(tradeObj["price"]);
+                trade.quantity = GetQuantity(tradeObj["quantity"]);
+                batch.trades.emplace_back(trade);
+            }
+        }
+
+        operation.tradesCount = batch.trades.size() - operation.firstTrade;
+        batch.operations.emplace_back(operation);
+    }
+
+    if (mParserHander)
+    {
+        mParserHander->OnMessageParsed(batch);
+    }
+}
+
 void JsonParser::ParseMarketStocks()
 {
     TinkoffApi::MarketStocksResponse marketStocksResponse;
@@ -200,11 +457,13 @@ void JsonParser::ParseMarketStocks()
         if (CheckExist(instrumentObj, "figi"))
         {
             instrument.figi = instrumentObj["figi"].GetString();
+            instrument.figiId = mSymbols->Intern(instrument.figi);
         }
 
         if (CheckExist(instrumentObj, "ticker"))
         {
             instrument.ticker = instrumentObj["ticker"].GetString();
+            instrument.tickerId = mSymbols->Intern(instrument.ticker);
         }
 
         if (CheckExist(instrumentObj, "isin"))
@@ -214,17 +473,18 @@ void JsonParser::ParseMarketStocks()
 
         if (CheckExist(instrumentObj, "minPriceIncrement"))
         {
-            instrument.minPriceIncrement = instrumentObj["minPriceIncrement"].GetDouble();
+            instrument.minPriceIncrement = GetMoney(instrumentObj["minPriceIncrement"]);
         }
 
         if (CheckExist(instrumentObj, "lot"))
         {
-            instrument.lot = instrumentObj["lot"].GetDouble();
+            instrument.lot = GetQuantity(instrumentObj["lot"]);
         }
 
         if (CheckExist(instrumentObj, "currency"))
         {
             instrument.currency = instrumentObj["currency"].GetString();
+            instrument.currencyId = mSymbols->Intern(instrument.currency);
         }
 
         if (CheckExist(instrumentObj, "name"))
@@ -258,10 +518,17 @@ bool JsonParser::CheckExist(const rapidjson::Value& aContainer, const std::strin
     return false;
 }
 
+void JsonParser::ResetDocument()
+{
+    // The pool keeps its first chunk, so the next document is built without new allocations
+    mDocument.SetNull();
+    mDocumentAllocator.Clear();
+}
+
 bool JsonParser::CheckJsonScheme(const std::string& aJsonString, std::string& outError)
 {
-    mDocument = rapidjson::Document{};
-    mDocument.Parse(aJsonString.c_str());
+    ResetDocument();
+    mDocument.Parse<ParseFlags>(aJsonString.c_str());
 
     if (mDocument.HasParseError())
     {
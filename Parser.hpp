@@ -1,25 +1,50 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
+#include <vector>
 
 #include <rapidjson/document.h>
 
+#include "ChunkedInputStream.hpp"
 #include "IParserHandler.hpp"
+#include "SymbolTable.hpp"
 #include "TinkoffApi.hpp"
 
 struct JsonParser
 {
 public:
-    explicit JsonParser(const std::shared_ptr<IParserHandler>& aProcessor);
+    enum class ParseMode
+    {
+        Dom = 0,
+        Sax = 1,
+        /// Operations are parsed in situ into string_view backed views
+        Insitu = 2
+    };
+
+    JsonParser(
+        const std::shared_ptr<IParserHandler>& aProcessor,
+        const std::shared_ptr<SymbolTable>& aSymbols,
+        ParseMode aParseMode = ParseMode::Sax);
 
     void Parse(
         const std::string& aJsonString,
         TinkoffApi::ResponseType aResponseType);
 
+    /// Parses the body while it is still arriving
+    void ParseStream(
+        ChunkedInputStream& aStream,
+        TinkoffApi::ResponseType aResponseType);
+
     void ParsePortfolio();
 
     void ParseOperations();
 
+    template <typename TInputStream>
+    void ParseOperationsSax(TInputStream& aStream);
+
+    void ParseOperationsInsitu(const std::string& aJsonString);
+
     void ParseMarketStocks();
 
     bool CheckExist(
@@ -29,7 +54,24 @@ public:
     bool CheckJsonScheme(const std::string& aJsonString, std::string& outError);
 
 private:
-    rapidjson::Document mDocument{};
+    void ParseDocument(TinkoffApi::ResponseType aResponseType);
+
+    void ResetDocument();
+
+    static constexpr std::size_t DocumentChunkSize = 1024 * 1024;
+    static constexpr std::size_t ArenaChunkSize = 1024 * 1024;
+
+    std::vector<char> mDocumentBuffer;
+    rapidjson::MemoryPoolAllocator<> mDocumentAllocator;
+    rapidjson::Document mDocument;
+
+    /// Per-response arena for the domain objects, released after the handler returns
+    std::pmr::monotonic_buffer_resource mArena;
 
     std::shared_ptr<IParserHandler> mParserHander;
+
+    /// FIGIs, tickers and currencies are interned here at parse time
+    std::shared_ptr<SymbolTable> mSymbols;
+
+    ParseMode mParseMode = ParseMode::Sax;
 };
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+
+#include "PositionEngine.hpp"
+
+namespace
+{
+    // __extension__ keeps -pedantic-errors quiet about the compiler specific type
+    __extension__ typedef __int128 TInt128;
+
+    Quantity Abs(Quantity aValue)
+    {
+        return aValue < 0 ? -aValue : aValue;
+    }
+
+    /// aMoney * aNumerator / aDenominator without overflowing the intermediate product
+    Money MulDiv(Money aMoney, Quantity aNumerator, Quantity aDenominator)
+    {
+        assert(aDenominator != 0);
+        const auto units = static_cast<TInt128>(aMoney.GetUnits()) * aNumerator / aDenominator;
+        return Money::FromUnits(static_cast<std::int64_t>(units));
+    }
+}
+
+void AllocateCommission(const TinkoffApi::Operation& aOperation, std::vector<Money>& outCommissions)
+{
+    outCommissions.assign(aOperation.trades.size(), Money{});
+    if (aOperation.trades.empty())
+    {
+        return;
+    }
+
+    Quantity totalQuantity = 0;
+    for (const auto& trade : aOperation.trades)
+    {
+        totalQuantity += trade.quantity;
+    }
+
+    const Money commission = aOperation.commission.value.Abs();
+    if (totalQuantity == 0)
+    {
+        outCommissions.back() = commission;
+        return;
+    }
+
+    Money allocated;
+    for (std::size_t index = 0; index + 1 < aOperation.trades.size(); ++index)
+    {
+        outCommissions[index] = MulDiv(commission, aOperation.trades[index].quantity, totalQuantity);
+        allocated += outCommissions[index];
+    }
+    outCommissions.back() = commission - allocated;
+}
+
+PositionEngine::PositionEngine(CostMethod aCostMethod)
+    : mCostMethod(aCostMethod)
+{
+}
+
+void PositionEngine::Reset()
+{
+    mLots.Clear();
+    mPosition = 0;
+    mCostBasis = Money{};
+    mRealizedProfitLoss = Money{};
+    mCommission = Money{};
+    mLastPrice = Money{};
+}
+
+void PositionEngine::Process(const InstrumentOperations::TOperations& aOperations)
+{
+    mEvents.clear();
+
+    for (const auto& operation : aOperations)
+    {
+        AllocateCommission(operation, mCommissions);
+
+        const auto side = operation.operationType == TinkoffApi::OperationType::Sell
+            ? TradeSide::Sell
+            : TradeSide::Buy;
+
+        for (std::size_t index = 0; index < operation.trades.size(); ++index)
+        {
+            const auto& trade = operation.trades[index];
+
+            TradeEvent event;
+            event.date = trade.date.empty() ? operation.date : trade.date;
+            event.operationId = operation.numericId;
+            event.tradeIndex = index;
+            event.side = side;
+            event.price = trade.price;
+            event.quantity = trade.quantity;
+            event.commission = mCommissions[index];
+            mEvents.emplace_back(event);
+        }
+    }
+
+    // Operations are ordered by id, matching needs the execution order
+    std::sort(
+        std::begin(mEvents),
+        std::end(mEvents),
+        [](const TradeEvent& aLeft, const TradeEvent& aRight)
+        {
+            return std::tie(aLeft.date, aLeft.operationId, aLeft.tradeIndex)
+                < std::tie(aRight.date, aRight.operationId, aRight.tradeIndex);
+        });
+
+    for (const auto& event : mEvents)
+    {
+        AddTrade(event.side, event.price, event.quantity, event.commission);
+    }
+}
+
+void PositionEngine::AddTrade(TradeSide aSide, Money aPrice, Quantity aQuantity, Money aCommission)
+{
+    mCommission += aCommission;
+    mLastPrice = aPrice;
+
+    const Quantity signedQuantity = aSide == TradeSide::Buy
+        ? aQuantity
+        : -aQuantity;
+
+    if (mCostMethod == CostMethod::AverageCost)
+    {
+        MatchAverageCost(aPrice, signedQuantity);
+    }
+    else
+    {
+        MatchLots(aPrice, signedQuantity);
+    }
+}
+
+PositionReport PositionEngine::GetReport() const
+{
+    PositionReport report;
+    report.realizedProfitLoss = mRealizedProfitLoss;
+    report.commission = mCommission;
+    report.position = mPosition;
+    report.markPrice = mLastPrice;
+
+    if (mPosition == 0)
+    {
+        return report;
+    }
+
+    if (mCostMethod == CostMethod::AverageCost)
+    {
+        const Money signedCost = mPosition > 0 ? mCostBasis : -mCostBasis;
+        report.unrealizedProfitLoss = mLastPrice * mPosition - signedCost;
+        report.openLots.push_back({mPosition, MulDiv(mCostBasis, 1, Abs(mPosition))});
+        return report;
+    }
+
+    report.openLots.reserve(mLots.Size());
+    for (std::size_t index = 0; index < mLots.Size(); ++index)
+    {
+        const auto& lot = mLots[index];
+        report.unrealizedProfitLoss += (mLastPrice - lot.price) * lot.quantity;
+        report.openLots.push_back(lot);
+    }
+    return report;
+}
+
+void PositionEngine::MatchLots(Money aPrice, Quantity aQuantity)
+{
+    Quantity remaining = aQuantity;
+
+    // All open lots have the same sign, the trade closes them while the signs differ
+    while (remaining != 0 && !mLots.Empty() && (mLots.Front().quantity > 0) != (remaining > 0))
+    {
+        Lot& lot = mCostMethod == CostMethod::Fifo
+            ? mLots.Front()
+            : mLots.Back();
+
+        const Quantity matched = std::min(Abs(lot.quantity), Abs(remaining));
+        const Quantity closed = lot.quantity > 0 ? matched : -matched;
+
+        mRealizedProfitLoss += (aPrice - lot.price) * closed;
+        lot.quantity -= closed;
+        remaining += closed;
+        mPosition -= closed;
+
+        if (lot.quantity == 0)
+        {
+            if (mCostMethod == CostMethod::Fifo)
+            {
+                mLots.PopFront();
+            }
+            else
+            {
+                mLots.PopBack();
+            }
+        }
+    }
+
+    if (remaining != 0)
+    {
+        mLots.PushBack({remaining, aPrice});
+        mPosition += remaining;
+    }
+}
+
+void PositionEngine::MatchAverageCost(Money aPrice, Quantity aQuantity)
+{
+    Quantity remaining = aQuantity;
+
+    if (mPosition != 0 && (mPosition > 0) != (remaining > 0))
+    {
+        const Quantity matched = std::min(Abs(mPosition), Abs(remaining));
+        const Quantity closed = mPosition > 0 ? matched : -matched;
+
+        const Money matchedCost = MulDiv(mCostBasis, matched, Abs(mPosition));
+        const Money signedMatchedCost = mPosition > 0 ? matchedCost : -matchedCost;
+
+        mRealizedProfitLoss += aPrice * closed - signedMatchedCost;
+        mCostBasis -= matchedCost;
+        mPosition -= closed;
+        remaining += closed;
+    }
+
+    if (remaining != 0)
+    {
+        mCostBasis += aPrice * Abs(remaining);
+        mPosition += remaining;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "InstrumentOperations.hpp"
+#include "Money.hpp"
+#include "RingBuffer.hpp"
+#include "TinkoffApi.hpp"
+
+enum class CostMethod
+{
+    Fifo = 0,
+    Lifo = 1,
+    AverageCost = 2
+};
+
+enum class TradeSide
+{
+    Buy = 0,
+    Sell = 1
+};
+
+/// Open lot, positive quantity for a long position, negative for a short one
+struct Lot
+{
+    Quantity quantity = 0;
+    Money price;
+};
+
+struct PositionReport
+{
+    Money realizedProfitLoss;
+    Money unrealizedProfitLoss;
+    Money commission;
+    Quantity position = 0;
+    /// Price of the last trade, used to value the open lots
+    Money markPrice;
+    std::vector<Lot> openLots;
+};
+
+/// Splits the operation commission between its trades proportionally to the quantity.
+/// The last trade takes the rounding remainder, so the shares sum up exactly.
+void AllocateCommission(const TinkoffApi::Operation& aOperation, std::vector<Money>& outCommissions);
+
+/// Matches buys against sells of one instrument and tracks realized P&L and open lots.
+/// Reset keeps the buffers, so one engine walks all instruments without per-trade allocations.
+class PositionEngine
+{
+public:
+    explicit PositionEngine(CostMethod aCostMethod = CostMethod::Fifo);
+
+    void Reset();
+
+    /// Feeds all trades of the accepted operations in time order
+    void Process(const InstrumentOperations::TOperations& aOperations);
+
+    void AddTrade(TradeSide aSide, Money aPrice, Quantity aQuantity, Money aCommission);
+
+    PositionReport GetReport() const;
+
+private:
+    struct TradeEvent
+    {
+        std::string_view date;
+        TinkoffApi::TOperationId operationId = TinkoffApi::InvalidOperationId;
+        std::size_t tradeIndex = 0;
+        TradeSide side = TradeSide::Buy;
+        Money price;
+        Quantity quantity = 0;
+        Money commission;
+    };
+
+    void MatchLots(Money aPrice, Quantity aQuantity);
+
+    void MatchAverageCost(Money aPrice, Quantity aQuantity);
+
+    CostMethod mCostMethod;
+
+    RingBuffer<Lot> mLots;
+
+    Quantity mPosition = 0;
+    /// Cost of the whole open position, used by the average cost method
+    Money mCostBasis;
+
+    Money mRealizedProfitLoss;
+    Money mCommission;
+    Money mLastPrice;
+
+    std::vector<TradeEvent> mEvents;
+    std::vector<Money> mCommissions;
+};
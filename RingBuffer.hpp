@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/// Double ended queue over one contiguous power of two sized buffer.
+/// Memory is only allocated when the buffer is full and is kept by Clear,
+/// so a reused buffer works without heap allocations in the steady state.
+template <typename T>
+class RingBuffer
+{
+public:
+    void PushBack(const T& aItem)
+    {
+        if (mSize == mItems.size())
+        {
+            Grow();
+        }
+        mItems[(mHead + mSize) & (mItems.size() - 1)] = aItem;
+        ++mSize;
+    }
+
+    T& Front()
+    {
+        assert(mSize != 0);
+        return mItems[mHead];
+    }
+
+    T& Back()
+    {
+        assert(mSize != 0);
+        return mItems[(mHead + mSize - 1) & (mItems.size() - 1)];
+    }
+
+    void PopFront()
+    {
+        assert(mSize != 0);
+        mHead = (mHead + 1) & (mItems.size() - 1);
+        --mSize;
+    }
+
+    void PopBack()
+    {
+        assert(mSize != 0);
+        --mSize;
+    }
+
+    /// Index counted from the front
+    const T& operator[](std::size_t aIndex) const
+    {
+        assert(aIndex < mSize);
+        return mItems[(mHead + aIndex) & (mItems.size() - 1)];
+    }
+
+    bool Empty() const
+    {
+        return mSize == 0;
+    }
+
+    std::size_t Size() const
+    {
+        return mSize;
+    }
+
+    void Clear()
+    {
+        mHead = 0;
+        mSize = 0;
+    }
+
+private:
+    void Grow()
+    {
+        std::vector<T> items(mItems.empty() ? InitialCapacity : mItems.size() * 2);
+        for (std::size_t index = 0; index < mSize; ++index)
+        {
+            items[index] = (*this)[index];
+        }
+        mItems.swap(items);
+        mHead = 0;
+    }
+
+    static constexpr std::size_t InitialCapacity = 16;
+
+    std::vector<T> mItems;
+    std::size_t mHead = 0;
+    std::size_t mSize = 0;
+};
@@ -1,16 +1,18 @@
 #pragma once
 
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
-#include <boost/asio/connect.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl/error.hpp>
-#include <boost/asio/ssl/stream.hpp>
 
+#include "ChunkedInputStream.hpp"
+#include "SslConnectionPool.hpp"
 #include "TinkoffApi.hpp"
 
 using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
@@ -36,49 +38,45 @@ class SimpleSslHttpClient
 {
 public:
     using THandler = std::function<void(const std::string&, TinkoffApi::ResponseType)>;
+    using TStreamHandler = std::function<void(ChunkedInputStream&, TinkoffApi::ResponseType)>;
 
-    explicit SimpleSslHttpClient()
+    explicit SimpleSslHttpClient(std::chrono::seconds aIdleTimeout = SslConnectionPool::DefaultIdleTimeout)
         : ioc()
         , ctx(ssl::context::sslv23_client)
-        , resolver(ioc)
-        , stream(ioc, ctx)
+        , pool(ioc, ctx, aIdleTimeout)
     {
     }
 
     void Connect(const std::string& aHost, const std::string& aPort)
     {
-        if(! SSL_set_tlsext_host_name(stream.native_handle(), aHost.c_str()))
-        {
-            boost::system::error_code ec{static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()};
-            throw boost::system::system_error{ec};
-        }
-
-        auto const results = resolver.resolve(aHost, aPort);
-
-        boost::asio::connect(stream.next_layer(), results.begin(), results.end());
-
-        // Perform the SSL handshake
-        stream.handshake(ssl::stream_base::client);
+        host = aHost;
+        port = aPort;
+        connection = pool.Acquire(host, port);
     }
 
     void SendHttpRequest(const http::request<http::string_body>& aHttpRequest)
     {
-        http::write(stream, aHttpRequest);
+        // Kept to be sent again if the server has dropped a reused connection
+        request = aHttpRequest;
+        WriteRequest();
     }
 
     void ProcessHttpResponse(const THandler& aHandler, TinkoffApi::ResponseType aResponseType)
     {
         boost::beast::flat_buffer buffer;
 
-        // Declare a container to hold the response
-        http::response<http::dynamic_body> res;
+        http::response_parser<http::dynamic_body> parser;
+        parser.body_limit((std::numeric_limits<std::uint64_t>::max)());
+
+        ReadResponse(buffer, parser, false);
 
-        // Receive the HTTP response
-        http::read(stream, buffer, res);
+        auto& res = parser.get();
 
         // Write the message to standard out
         std::cout << "Http response:" << res << std::endl;
 
+        pool.Release(std::move(connection), parser.keep_alive());
+
         if (!aHandler)
         {
             std::cerr << "Response handler is not initialized";
@@ -88,22 +86,64 @@ public:
         aHandler(boost::beast::buffers_to_string(res.body().data()), aResponseType);
     }
 
-    void Shutdown()
+    /// Hands the body to the handler chunk by chunk while it is being received
+    void ProcessHttpResponseStreaming(const TStreamHandler& aHandler, TinkoffApi::ResponseType aResponseType)
     {
-        boost::system::error_code ec;
-        stream.shutdown(ec);
-        if(ec == boost::asio::error::eof)
+        boost::beast::flat_buffer buffer;
+
+        http::response_parser<http::buffer_body> parser;
+        parser.body_limit((std::numeric_limits<std::uint64_t>::max)());
+
+        ReadResponse(buffer, parser, true);
+
+        std::cout << "Http response:" << parser.get().base() << std::endl;
+
+        ChunkedInputStream bodyStream(
+            [this, &buffer, &parser](char* aData, std::size_t aSize)
+            {
+                return ReadBodyChunk(buffer, parser, aData, aSize);
+            });
+
+        if (!aHandler)
+        {
+            std::cerr << "Response handler is not initialized";
+        }
+        else
         {
-            // Rationale:
-            // http://stackoverflow.com/questions/25587403/boost-asio-ssl-async-shutdown-always-finishes-with-an-error
-            ec.assign(0, ec.category());
+            aHandler(bodyStream, aResponseType);
         }
 
-        if (ec)
+        // Drain the rest of the body so the next response starts at a message boundary
+        char rest[4096];
+        while (ReadBodyChunk(buffer, parser, rest, sizeof(rest)) != 0)
         {
-            boost::system::system_error ex{ec};
-            std::cerr << "Shutdown error: " << ex.what() << std::endl;
         }
+
+        pool.Release(std::move(connection), parser.keep_alive());
+    }
+
+    void Shutdown()
+    {
+        if (connection)
+        {
+            boost::system::error_code ec;
+            connection->stream.shutdown(ec);
+            if(ec == boost::asio::error::eof)
+            {
+                // Rationale:
+                // http://stackoverflow.com/questions/25587403/boost-asio-ssl-async-shutdown-always-finishes-with-an-error
+                ec.assign(0, ec.category());
+            }
+
+            if (ec)
+            {
+                boost::system::system_error ex{ec};
+                std::cerr << "Shutdown error: " << ex.what() << std::endl;
+            }
+            connection.reset();
+        }
+
+        pool.Clear();
     }
 
     ~SimpleSslHttpClient()
@@ -112,10 +152,123 @@ public:
     }
 
 private:
+    /// Errors of a keep-alive connection the server has closed while it was idle
+    static bool IsStaleConnectionError(const boost::system::error_code& aError)
+    {
+        return aError == http::error::end_of_stream
+            || aError == boost::asio::error::eof
+            || aError == boost::asio::error::connection_reset
+            || aError == boost::asio::error::broken_pipe
+            || aError == ssl::error::stream_truncated;
+    }
+
+    void Reconnect()
+    {
+        connection.reset();
+        connection = pool.Connect(host, port);
+    }
+
+    void WriteRequest()
+    {
+        if (!connection)
+        {
+            connection = pool.Acquire(host, port);
+        }
+
+        boost::system::error_code ec;
+        http::write(connection->stream, request, ec);
+
+        if (ec && connection->isReused && IsStaleConnectionError(ec))
+        {
+            Reconnect();
+            http::write(connection->stream, request, ec);
+        }
+
+        if (ec)
+        {
+            connection.reset();
+            throw boost::system::system_error{ec};
+        }
+    }
+
+    /// Reads the whole response or only its header.
+    /// A reused connection closed before the first response byte is reopened and the request is sent again.
+    template<class TParser>
+    void ReadResponse(boost::beast::flat_buffer& aBuffer, TParser& aParser, bool aHeaderOnly)
+    {
+        const auto read = [this, &aBuffer, &aParser, aHeaderOnly](boost::system::error_code& outError)
+        {
+            if (aHeaderOnly)
+            {
+                http::read_header(connection->stream, aBuffer, aParser, outError);
+            }
+            else
+            {
+                http::read(connection->stream, aBuffer, aParser, outError);
+            }
+        };
+
+        boost::system::error_code ec;
+        read(ec);
+
+        if (ec && connection->isReused && !aParser.got_some() && IsStaleConnectionError(ec))
+        {
+            Reconnect();
+            http::write(connection->stream, request, ec);
+            if (!ec)
+            {
+                read(ec);
+            }
+        }
+
+        if (ec)
+        {
+            connection.reset();
+            throw boost::system::system_error{ec};
+        }
+    }
+
+    std::size_t ReadBodyChunk(
+        boost::beast::flat_buffer& aBuffer,
+        http::response_parser<http::buffer_body>& aParser,
+        char* aData,
+        std::size_t aSize)
+    {
+        // A read may only consume chunk framing, keep going until body bytes arrive
+        while (!aParser.is_done())
+        {
+            aParser.get().body().data = aData;
+            aParser.get().body().size = aSize;
+
+            boost::system::error_code ec;
+            http::read(connection->stream, aBuffer, aParser, ec);
+
+            if (ec && ec != http::error::need_buffer)
+            {
+                connection.reset();
+                throw boost::system::system_error{ec};
+            }
+
+            const std::size_t bytesRead = aSize - aParser.get().body().size;
+            if (bytesRead != 0)
+            {
+                return bytesRead;
+            }
+        }
+        return 0;
+    }
+
     boost::asio::io_context ioc;
     ssl::context ctx;
-    tcp::resolver resolver;
-    ssl::stream<tcp::socket> stream;
+    SslConnectionPool pool;
+
+    std::string host;
+    std::string port;
+
+    /// Connection of the current request, it goes back to the pool once the response is read
+    SslConnectionPool::TConnectionPtr connection;
+
+    http::request<http::string_body> request;
 };
 
 http::request<http::string_body> MakePortfolioRequest(
@@ -0,0 +1,189 @@
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ssl/error.hpp>
+
+#include "SslConnectionPool.hpp"
+
+using tcp = boost::asio::ip::tcp;
+namespace ssl = boost::asio::ssl;
+
+SslConnection::SslConnection(
+    boost::asio::io_context& aIoContext,
+    boost::asio::ssl::context& aSslContext,
+    const std::string& aKey)
+    : stream(aIoContext, aSslContext)
+    , key(aKey)
+    , lastUsed(std::chrono::steady_clock::now())
+{
+}
+
+SslConnectionPool::SslConnectionPool(
+    boost::asio::io_context& aIoContext,
+    boost::asio::ssl::context& aSslContext,
+    std::chrono::seconds aIdleTimeout,
+    std::size_t aMaxIdlePerHost)
+    : mIoContext(aIoContext)
+    , mSslContext(aSslContext)
+    , mResolver(aIoContext)
+    , mIdleTimeout(aIdleTimeout)
+    , mMaxIdlePerHost(aMaxIdlePerHost)
+{
+    // Sessions are kept by the pool, the context only has to issue them to the client
+    SSL_CTX_set_session_cache_mode(
+        mSslContext.native_handle(),
+        SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+}
+
+SslConnectionPool::~SslConnectionPool()
+{
+    Clear();
+}
+
+SslConnectionPool::TConnectionPtr SslConnectionPool::Acquire(const std::string& aHost, const std::string& aPort)
+{
+    const auto it = mIdleConnections.find(MakeKey(aHost, aPort));
+    if (it != mIdleConnections.end())
+    {
+        auto& idle = it->second;
+        const auto now = std::chrono::steady_clock::now();
+
+        // The most recently used connection is the most likely to be still open
+        while (!idle.empty())
+        {
+            auto connection = std::move(idle.back());
+            idle.pop_back();
+
+            if (now - connection->lastUsed < mIdleTimeout && IsAlive(*connection))
+            {
+                connection->isReused = true;
+                return connection;
+            }
+            Close(*connection, false);
+        }
+    }
+
+    return Connect(aHost, aPort);
+}
+
+SslConnectionPool::TConnectionPtr SslConnectionPool::Connect(const std::string& aHost, const std::string& aPort)
+{
+    const auto key = MakeKey(aHost, aPort);
+    auto connection = std::make_unique<SslConnection>(mIoContext, mSslContext, key);
+
+    auto* nativeHandle = connection->stream.native_handle();
+    if (!SSL_set_tlsext_host_name(nativeHandle, aHost.c_str()))
+    {
+        boost::system::error_code ec{static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()};
+        throw boost::system::system_error{ec};
+    }
+
+    const auto session = mSessions.find(key);
+    if (session != mSessions.end())
+    {
+        SSL_set_session(nativeHandle, session->second.get());
+    }
+
+    auto const results = mResolver.resolve(aHost, aPort);
+    boost::asio::connect(connection->stream.next_layer(), results.begin(), results.end());
+
+    connection->stream.handshake(ssl::stream_base::client);
+    connection->isResumed = SSL_session_reused(nativeHandle) != 0;
+    connection->lastUsed = std::chrono::steady_clock::now();
+
+    return connection;
+}
+
+void SslConnectionPool::Release(TConnectionPtr aConnection, bool aKeepAlive)
+{
+    if (!aConnection)
+    {
+        return;
+    }
+
+    // TLS 1.3 tickets arrive after the handshake, so the session is taken after the exchange
+    SaveSession(*aConnection);
+
+    auto& idle = mIdleConnections[aConnection->key];
+    if (!aKeepAlive || idle.size() >= mMaxIdlePerHost)
+    {
+        Close(*aConnection, false);
+        return;
+    }
+
+    aConnection->lastUsed = std::chrono::steady_clock::now();
+    idle.emplace_back(std::move(aConnection));
+}
+
+void SslConnectionPool::Clear()
+{
+    for (auto& [key, connections] : mIdleConnections)
+    {
+        for (auto& connection : connections)
+        {
+            Close(*connection, true);
+        }
+    }
+    mIdleConnections.clear();
+}
+
+std::size_t SslConnectionPool::GetIdleCount() const
+{
+    std::size_t count = 0;
+    for (const auto& [key, connections] : mIdleConnections)
+    {
+        count += connections.size();
+    }
+    return count;
+}
+
+void SslConnectionPool::SessionDeleter::operator()(SSL_SESSION* aSession) const
+{
+    SSL_SESSION_free(aSession);
+}
+
+std::string SslConnectionPool::MakeKey(const std::string& aHost, const std::string& aPort)
+{
+    return aHost + ":" + aPort;
+}
+
+bool SslConnectionPool::IsAlive(SslConnection& aConnection)
+{
+    auto& socket = aConnection.stream.next_layer();
+    if (!socket.is_open())
+    {
+        return false;
+    }
+
+    boost::system::error_code ec;
+    socket.non_blocking(true, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    char byte = 0;
+    socket.receive(boost::asio::buffer(&byte, 1), tcp::socket::message_peek, ec);
+
+    boost::system::error_code modeError;
+    socket.non_blocking(false, modeError);
+
+    return ec == boost::asio::error::would_block && !modeError;
+}
+
+void SslConnectionPool::Close(SslConnection& aConnection, bool aGraceful)
+{
+    boost::system::error_code ec;
+    if (aGraceful)
+    {
+        // Waits for the close notify of the server, errors of a dropped peer are expected here
+        aConnection.stream.shutdown(ec);
+    }
+    aConnection.stream.next_layer().close(ec);
+}
+
+void SslConnectionPool::SaveSession(SslConnection& aConnection)
+{
+    if (SSL_SESSION* session = SSL_get1_session(aConnection.stream.native_handle()))
+    {
+        mSessions[aConnection.key].reset(session);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/ssl/stream.hpp>
+
+/// TLS connection to one host:port
+struct SslConnection
+{
+    SslConnection(
+        boost::asio::io_context& aIoContext,
+        boost::asio::ssl::context& aSslContext,
+        const std::string& aKey);
+
+    boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream;
+
+    /// host:port the connection belongs to
+    std::string key;
+
+    std::chrono::steady_clock::time_point lastUsed;
+
+    /// Set when the connection is taken from the pool, a reused connection may be already closed by the server
+    bool isReused = false;
+
+    /// Set when the handshake resumed a previous TLS session
+    bool isResumed = false;
+};
+
+/// Keep-alive pool of TLS connections keyed by host:port.
+/// Idle connections are dropped after the idle timeout or when the server has closed them,
+/// new connections resume the last TLS session of the host to skip the full handshake.
+class SslConnectionPool
+{
+public:
+    using TConnectionPtr = std::unique_ptr<SslConnection>;
+
+    static constexpr std::chrono::seconds DefaultIdleTimeout{30};
+    static constexpr std::size_t DefaultMaxIdlePerHost = 4;
+
+    SslConnectionPool(
+        boost::asio::io_context& aIoContext,
+        boost::asio::ssl::context& aSslContext,
+        std::chrono::seconds aIdleTimeout = DefaultIdleTimeout,
+        std::size_t aMaxIdlePerHost = DefaultMaxIdlePerHost);
+
+    SslConnectionPool(const SslConnectionPool&) = delete;
+    SslConnectionPool& operator=(const SslConnectionPool&) = delete;
+
+    ~SslConnectionPool();
+
+    /// Takes a live idle connection to the host or opens a new one.
+    /// Throws boost::system::system_error when a new connection can't be established.
+    TConnectionPtr Acquire(const std::string& aHost, const std::string& aPort);
+
+    /// Opens a new connection, idle ones are left in the pool
+    TConnectionPtr Connect(const std::string& aHost, const std::string& aPort);
+
+    /// Returns the connection to the pool, a connection without keep-alive is closed
+    void Release(TConnectionPtr aConnection, bool aKeepAlive);
+
+    /// Gracefully shuts down all idle connections
+    void Clear();
+
+    std::size_t GetIdleCount() const;
+
+private:
+    struct SessionDeleter
+    {
+        void operator()(SSL_SESSION* aSession) const;
+    };
+
+    using TSessionPtr = std::unique_ptr<SSL_SESSION, SessionDeleter>;
+
+    static std::string MakeKey(const std::string& aHost, const std::string& aPort);
+
+    /// An idle connection must be silent, any pending data, EOF or error means the server dropped it
+    static bool IsAlive(SslConnection& aConnection);
+
+    static void Close(SslConnection& aConnection, bool aGraceful);
+
+    void SaveSession(SslConnection& aConnection);
+
+    boost::asio::io_context& mIoContext;
+    boost::asio::ssl::context& mSslContext;
+    boost::asio::ip::tcp::resolver mResolver;
+
+    std::chrono::seconds mIdleTimeout;
+    std::size_t mMaxIdlePerHost;
+
+    std::map<std::string, std::vector<TConnectionPtr>> mIdleConnections;
+
+    /// Last TLS session of every host:port
+    std::map<std::string, TSessionPtr> mSessions;
+};
@@ -0,0 +1,42 @@
+#include <cassert>
+
+#include "SymbolTable.hpp"
+
+TSymbolId SymbolTable::Intern(std::string_view aSymbol)
+{
+    if (aSymbol.empty())
+    {
+        return InvalidSymbolId;
+    }
+
+    const auto it = mIds.find(aSymbol);
+    if (it != mIds.end())
+    {
+        return it->second;
+    }
+
+    const auto id = static_cast<TSymbolId>(mSymbols.size());
+    const auto& symbol = mSymbols.emplace_back(aSymbol);
+    mIds.emplace(symbol, id);
+
+    return id;
+}
+
+TSymbolId SymbolTable::Find(std::string_view aSymbol) const
+{
+    const auto it = mIds.find(aSymbol);
+    return it != mIds.end()
+        ? it->second
+        : InvalidSymbolId;
+}
+
+const std::string& SymbolTable::GetSymbol(TSymbolId aId) const
+{
+    assert(aId < mSymbols.size());
+    return mSymbols[aId];
+}
+
+std::size_t SymbolTable::Size() const
+{
+    return mSymbols.size();
+}
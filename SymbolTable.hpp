@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using TSymbolId = std::uint32_t;
+
+constexpr TSymbolId InvalidSymbolId = std::numeric_limits<TSymbolId>::max();
+
+/// Interns FIGIs, tickers and currencies into dense ids starting from 0,
+/// so they can index flat vectors instead of string keyed maps.
+class SymbolTable
+{
+public:
+    /// Empty symbols are not interned and get InvalidSymbolId
+    TSymbolId Intern(std::string_view aSymbol);
+
+    /// Returns InvalidSymbolId for a symbol that was never interned
+    TSymbolId Find(std::string_view aSymbol) const;
+
+    const std::string& GetSymbol(TSymbolId aId) const;
+
+    std::size_t Size() const;
+
+private:
+    // deque keeps the interned strings in place, so the views used as keys stay valid
+    std::deque<std::string> mSymbols;
+    std::unordered_map<std::string_view, TSymbolId> mIds;
+};
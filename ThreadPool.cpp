@@ -0,0 +1,168 @@
+#include <algorithm>
+
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(std::size_t aThreadsCount)
+{
+    if (aThreadsCount == 0)
+    {
+        aThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    mQueues.reserve(aThreadsCount);
+    for (std::size_t index = 0; index < aThreadsCount; ++index)
+    {
+        mQueues.emplace_back(std::make_unique<WorkerQueue>());
+    }
+
+    mThreads.reserve(aThreadsCount);
+    for (std::size_t index = 0; index < aThreadsCount; ++index)
+    {
+        mThreads.emplace_back(&ThreadPool::Run, this, index);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopped = true;
+    }
+    mTaskAdded.notify_all();
+
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::GetThreadsCount() const
+{
+    return mThreads.size();
+}
+
+void ThreadPool::Submit(TTask aTask)
+{
+    // Tasks are spread round-robin, idle workers steal the rest
+    auto& queue = *mQueues[mNextQueue++ % mQueues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.emplace_back(std::move(aTask));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mPendingCount;
+        ++mQueuedCount;
+    }
+    mTaskAdded.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTasksDone.wait(lock, [this] { return mPendingCount == 0; });
+}
+
+void ThreadPool::ParallelFor(
+    std::size_t aCount,
+    std::size_t aGrainSize,
+    const std::function<void(std::size_t aIndex, std::size_t aWorkerIndex)>& aFunction)
+{
+    aGrainSize = std::max<std::size_t>(aGrainSize, 1);
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    for (std::size_t begin = 0; begin < aCount; begin += aGrainSize)
+    {
+        const std::size_t end = std::min(aCount, begin + aGrainSize);
+        Submit([begin, end, &aFunction, &errorMutex, &error](std::size_t aWorkerIndex)
+        {
+            try
+            {
+                for (std::size_t index = begin; index < end; ++index)
+                {
+                    aFunction(index, aWorkerIndex);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+
+    Wait();
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::Run(std::size_t aWorkerIndex)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskAdded.wait(lock, [this] { return mStopped || mQueuedCount > 0; });
+            if (mQueuedCount == 0)
+            {
+                return;
+            }
+            // Reserves one queued task, so the scan below always finds one
+            --mQueuedCount;
+        }
+
+        TTask task;
+        while (!PopTask(aWorkerIndex, task))
+        {
+            std::this_thread::yield();
+        }
+
+        task(aWorkerIndex);
+
+        bool isDone = false;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            isDone = --mPendingCount == 0;
+        }
+        if (isDone)
+        {
+            mTasksDone.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::PopTask(std::size_t aWorkerIndex, TTask& outTask)
+{
+    {
+        auto& own = *mQueues[aWorkerIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            outTask = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < mQueues.size(); ++offset)
+    {
+        auto& victim = *mQueues[(aWorkerIndex + offset) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            outTask = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
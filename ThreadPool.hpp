@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fixed size work-stealing thread pool.
+/// Every worker owns a task queue, pops its own tasks from the back and steals
+/// from the front of the other queues when its own queue is empty.
+class ThreadPool
+{
+public:
+    /// Task gets the index of the worker that runs it, in [0, GetThreadsCount())
+    using TTask = std::function<void(std::size_t aWorkerIndex)>;
+
+    /// Zero threads means std::thread::hardware_concurrency
+    explicit ThreadPool(std::size_t aThreadsCount = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    std::size_t GetThreadsCount() const;
+
+    void Submit(TTask aTask);
+
+    /// Blocks until all submitted tasks are done
+    void Wait();
+
+    /// Runs aFunction for every index in [0, aCount) in chunks of aGrainSize indexes and waits.
+    /// The first exception thrown by aFunction is rethrown to the caller.
+    void ParallelFor(
+        std::size_t aCount,
+        std::size_t aGrainSize,
+        const std::function<void(std::size_t aIndex, std::size_t aWorkerIndex)>& aFunction);
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<TTask> tasks;
+    };
+
+    void Run(std::size_t aWorkerIndex);
+
+    bool PopTask(std::size_t aWorkerIndex, TTask& outTask);
+
+    std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    std::atomic<std::size_t> mNextQueue{0};
+
+    std::mutex mMutex;
+    std::condition_variable mTaskAdded;
+    std::condition_variable mTasksDone;
+    /// Submitted tasks that are not finished yet, guarded by mMutex
+    std::size_t mPendingCount = 0;
+    /// Tasks waiting in the queues, guarded by mMutex
+    std::size_t mQueuedCount = 0;
+    bool mStopped = false;
+};
@@ -1,7 +1,16 @@
 #pragma once
 
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "Money.hpp"
+#include "SymbolTable.hpp"
 #include "UrlEncoder.hpp"
 
 namespace TinkoffApi
@@ -15,53 +24,415 @@ namespace TinkoffApi
         MarketStocksResponse = 4
     };
 
+    enum class OperationType
+    {
+        UNDEFINED = 0,
+        Buy = 1,
+        BuyCard = 2,
+        Sell = 3,
+        BrokerCommission = 4,
+        ExchangeCommission = 5,
+        ServiceCommission = 6,
+        MarginCommission = 7,
+        OtherCommission = 8,
+        PayIn = 9,
+        PayOut = 10,
+        Tax = 11,
+        TaxLucre = 12,
+        TaxDividend = 13,
+        TaxCoupon = 14,
+        TaxBack = 15,
+        Repayment = 16,
+        PartRepayment = 17,
+        Coupon = 18,
+        Dividend = 19,
+        SecurityIn = 20,
+        SecurityOut = 21
+    };
+
+    enum class OperationStatus
+    {
+        UNDEFINED = 0,
+        Done = 1,
+        Decline = 2,
+        Progress = 3
+    };
+
+    enum class InstrumentType
+    {
+        UNDEFINED = 0,
+        Stock = 1,
+        Currency = 2,
+        Bond = 3,
+        Etf = 4
+    };
+
+    inline OperationType ParseOperationType(std::string_view aValue)
+    {
+        static const std::unordered_map<std::string_view, OperationType> operationTypes
+        {
+            {"Buy", OperationType::Buy},
+            {"BuyCard", OperationType::BuyCard},
+            {"Sell", OperationType::Sell},
+            {"BrokerCommission", OperationType::BrokerCommission},
+            {"ExchangeCommission", OperationType::ExchangeCommission},
+            {"ServiceCommission", OperationType::ServiceCommission},
+            {"MarginCommission", OperationType::MarginCommission},
+            {"OtherCommission", OperationType::OtherCommission},
+            {"PayIn", OperationType::PayIn},
+            {"PayOut", OperationType::PayOut},
+            {"Tax", OperationType::Tax},
+            {"TaxLucre", OperationType::TaxLucre},
+            {"TaxDividend", OperationType::TaxDividend},
+            {"TaxCoupon", OperationType::TaxCoupon},
+            {"TaxBack", OperationType::TaxBack},
+            {"Repayment", OperationType::Repayment},
+            {"PartRepayment", OperationType::PartRepayment},
+            {"Coupon", OperationType::Coupon},
+            {"Dividend", OperationType::Dividend},
+            {"SecurityIn", OperationType::SecurityIn},
+            {"SecurityOut", OperationType::SecurityOut}
+        };
+
+        const auto it = operationTypes.find(aValue);
+        return it != operationTypes.end()
+            ? it->second
+            : OperationType::UNDEFINED;
+    }
+
+    inline OperationStatus ParseOperationStatus(std::string_view aValue)
+    {
+        if (aValue == "Done")
+        {
+            return OperationStatus::Done;
+        }
+        if (aValue == "Decline")
+        {
+            return OperationStatus::Decline;
+        }
+        if (aValue == "Progress")
+        {
+            return OperationStatus::Progress;
+        }
+        return OperationStatus::UNDEFINED;
+    }
+
+    inline InstrumentType ParseInstrumentType(std::string_view aValue)
+    {
+        if (aValue == "Stock")
+        {
+            return InstrumentType::Stock;
+        }
+        if (aValue == "Currency")
+        {
+            return InstrumentType::Currency;
+        }
+        if (aValue == "Bond")
+        {
+            return InstrumentType::Bond;
+        }
+        if (aValue == "Etf")
+        {
+            return InstrumentType::Etf;
+        }
+        return InstrumentType::UNDEFINED;
+    }
+
+    using TOperationId = std::int64_t;
+
+    constexpr TOperationId InvalidOperationId = std::numeric_limits<TOperationId>::min();
+
+    /// Operation ids come as strings, they are parsed once so ordering is an integer compare
+    inline TOperationId ParseOperationId(std::string_view aId)
+    {
+        TOperationId id = InvalidOperationId;
+        std::from_chars(aId.data(), aId.data() + aId.size(), id);
+        return id;
+    }
+
     struct Portfolio
     {
         std::vector<std::string> positions;
     };
 
+    /// Allocator of the operations response types. Objects built on a
+    /// per-response arena must be copied, not moved, into long-lived storage.
+    using TAllocator = std::pmr::polymorphic_allocator<char>;
+
     struct Trade
     {
-        std::string tradeId;
-        std::string date;
-        double price = 0.0;
-        double quantity = 0.0;
+        using allocator_type = TAllocator;
+
+        Trade() = default;
+        Trade(const Trade&) = default;
+        Trade(Trade&&) = default;
+        Trade& operator=(const Trade&) = default;
+        Trade& operator=(Trade&&) = default;
+
+        explicit Trade(const allocator_type& aAllocator)
+            : tradeId(aAllocator)
+            , date(aAllocator)
+        {
+        }
+
+        Trade(const Trade& aOther, const allocator_type& aAllocator)
+            : tradeId(aOther.tradeId, aAllocator)
+            , date(aOther.date, aAllocator)
+            , price(aOther.price)
+            , quantity(aOther.quantity)
+        {
+        }
+
+        Trade(Trade&& aOther, const allocator_type& aAllocator)
+            : tradeId(std::move(aOther.tradeId), aAllocator)
+            , date(std::move(aOther.date), aAllocator)
+            , price(aOther.price)
+            , quantity(aOther.quantity)
+        {
+        }
+
+        std::pmr::string tradeId;
+        std::pmr::string date;
+        Money price;
+        Quantity quantity = 0;
     };
 
     struct Commission
     {
-        std::string currency;
-        double value = 0.0;
+        using allocator_type = TAllocator;
+
+        Commission() = default;
+        Commission(const Commission&) = default;
+        Commission(Commission&&) = default;
+        Commission& operator=(const Commission&) = default;
+        Commission& operator=(Commission&&) = default;
+
+        explicit Commission(const allocator_type& aAllocator)
+            : currency(aAllocator)
+        {
+        }
+
+        Commission(const Commission& aOther, const allocator_type& aAllocator)
+            : currency(aOther.currency, aAllocator)
+            , value(aOther.value)
+        {
+        }
+
+        Commission(Commission&& aOther, const allocator_type& aAllocator)
+            : currency(std::move(aOther.currency), aAllocator)
+            , value(aOther.value)
+        {
+        }
+
+        std::pmr::string currency;
+        Money value;
     };
 
     struct Operation
     {
-        std::string id;
-        std::string status;
-        std::vector<Trade> trades;
+        using allocator_type = TAllocator;
+
+        Operation() = default;
+        Operation(const Operation&) = default;
+        Operation(Operation&&) = default;
+        Operation& operator=(const Operation&) = default;
+        Operation& operator=(Operation&&) = default;
+
+        explicit Operation(const allocator_type& aAllocator)
+            : id(aAllocator)
+            , trades(aAllocator)
+            , commission(aAllocator)
+            , currency(aAllocator)
+            , figi(aAllocator)
+            , date(aAllocator)
+        {
+        }
+
+        Operation(const Operation& aOther, const allocator_type& aAllocator)
+            : id(aOther.id, aAllocator)
+            , numericId(aOther.numericId)
+            , status(aOther.status)
+            , trades(aOther.trades, aAllocator)
+            , commission(aOther.commission, aAllocator)
+            , currency(aOther.currency, aAllocator)
+            , currencyId(aOther.currencyId)
+            , payment(aOther.payment)
+            , price(aOther.price)
+            , quantity(aOther.quantity)
+            , figi(aOther.figi, aAllocator)
+            , figiId(aOther.figiId)
+            , instrumentType(aOther.instrumentType)
+            , isMarginCall(aOther.isMarginCall)
+            , date(aOther.date, aAllocator)
+            , operationType(aOther.operationType)
+        {
+        }
+
+        Operation(Operation&& aOther, const allocator_type& aAllocator)
+            : id(std::move(aOther.id), aAllocator)
+            , numericId(aOther.numericId)
+            , status(aOther.status)
+            , trades(std::move(aOther.trades), aAllocator)
+            , commission(std::move(aOther.commission), aAllocator)
+            , currency(std::move(aOther.currency), aAllocator)
+            , currencyId(aOther.currencyId)
+            , payment(aOther.payment)
+            , price(aOther.price)
+            , quantity(aOther.quantity)
+            , figi(std::move(aOther.figi), aAllocator)
+            , figiId(aOther.figiId)
+            , instrumentType(aOther.instrumentType)
+            , isMarginCall(aOther.isMarginCall)
+            , date(std::move(aOther.date), aAllocator)
+            , operationType(aOther.operationType)
+        {
+        }
+
+        std::pmr::string id;
+        TOperationId numericId = InvalidOperationId;
+        OperationStatus status = OperationStatus::UNDEFINED;
+        std::pmr::vector<Trade> trades;
         Commission commission;
-        std::string currency;
-        double payment = 0.0;
-        double price = 0.0;
-        double quantity = 0.0;
-        std::string figi;
-        std::string instrumentType;
+        std::pmr::string currency;
+        TSymbolId currencyId = InvalidSymbolId;
+        Money payment;
+        Money price;
+        Quantity quantity = 0;
+        std::pmr::string figi;
+        TSymbolId figiId = InvalidSymbolId;
+        InstrumentType instrumentType = InstrumentType::UNDEFINED;
         bool isMarginCall = false;
-        std::string date;
-        std::string operationType;
+        std::pmr::string date;
+        OperationType operationType = OperationType::UNDEFINED;
     };
 
     inline bool operator<(const Operation& aLeft, const Operation& aRight) noexcept
     {
-        return std::stoll(aLeft.id) < std::stoll(aRight.id);
+        return aLeft.numericId < aRight.numericId;
     }
 
     struct OperationsResponse
     {
-        std::string trackingId;
-        std::string status;
+        using allocator_type = TAllocator;
+
+        OperationsResponse() = default;
+
+        explicit OperationsResponse(const allocator_type& aAllocator)
+            : trackingId(aAllocator)
+            , status(aAllocator)
+            , operations(aAllocator)
+        {
+        }
+
+        std::pmr::string trackingId;
+        std::pmr::string status;
+
+        std::pmr::vector<Operation> operations;
+    };
+
+    struct TradeView
+    {
+        std::string_view tradeId;
+        std::string_view date;
+        Money price;
+        Quantity quantity = 0;
+    };
+
+    struct CommissionView
+    {
+        std::string_view currency;
+        Money value;
+    };
 
-        std::vector<Operation> operations;
+    /// Operation whose strings point into OperationsViewBatch::body
+    struct OperationView
+    {
+        std::string_view id;
+        TOperationId numericId = InvalidOperationId;
+        OperationStatus status = OperationStatus::UNDEFINED;
+        std::size_t firstTrade = 0;
+        std::size_t tradesCount = 0;
+        CommissionView commission;
+        std::string_view currency;
+        TSymbolId currencyId = InvalidSymbolId;
+        Money payment;
+        Money price;
+        Quantity quantity = 0;
+        std::string_view figi;
+        TSymbolId figiId = InvalidSymbolId;
+        InstrumentType instrumentType = InstrumentType::UNDEFINED;
+        bool isMarginCall = false;
+        std::string_view date;
+        OperationType operationType = OperationType::UNDEFINED;
+    };
+
+    struct TradeViewRange
+    {
+        const TradeView* first = nullptr;
+        const TradeView* last = nullptr;
+
+        const TradeView* begin() const
+        {
+            return first;
+        }
+
+        const TradeView* end() const
+        {
+            return last;
+        }
+
+        bool empty() const
+        {
+            return first == last;
+        }
+    };
+
+    /// Operations parsed in situ. The batch owns the body buffer,
+    /// so the views are valid only while the batch is alive.
+    struct OperationsViewBatch
+    {
+        std::vector<char> body;
+        std::vector<OperationView> operations;
+        std::vector<TradeView> trades;
+
+        TradeViewRange GetTrades(const OperationView& aOperation) const
+        {
+            const TradeView* first = trades.data() + aOperation.firstTrade;
+            return {first, first + aOperation.tradesCount};
+        }
+
+        Operation ToOperation(const OperationView& aView) const
+        {
+            Operation operation;
+            operation.id = aView.id;
+            operation.numericId = aView.numericId;
+            operation.status = aView.status;
+            operation.commission.currency = aView.commission.currency;
+            operation.commission.value = aView.commission.value;
+            operation.currency = aView.currency;
+            operation.currencyId = aView.currencyId;
+            operation.payment = aView.payment;
+            operation.price = aView.price;
+            operation.quantity = aView.quantity;
+            operation.figi = aView.figi;
+            operation.figiId = aView.figiId;
+            operation.instrumentType = aView.instrumentType;
+            operation.isMarginCall = aView.isMarginCall;
+            operation.date = aView.date;
+            operation.operationType = aView.operationType;
+
+            operation.trades.reserve(aView.tradesCount);
+            for (const auto& tradeView : GetTrades(aView))
+            {
+                Trade trade;
+                trade.tradeId = tradeView.tradeId;
+                trade.date = tradeView.date;
+                trade.price = tradeView.price;
+                trade.quantity = tradeView.quantity;
+                operation.trades.emplace_back(std::move(trade));
+            }
+            return operation;
+        }
     };
 
     struct OperationRequest
@@ -79,11 +450,14 @@ namespace TinkoffApi
     struct StockInstrument
     {
         std::string figi;
+        TSymbolId figiId = InvalidSymbolId;
         std::string ticker;
+        TSymbolId tickerId = InvalidSymbolId;
         std::string isin;
-        double minPriceIncrement = 0;
-        double lot = 0;
+        Money minPriceIncrement;
+        Quantity lot = 0;
         std::string currency;
+        TSymbolId currencyId = InvalidSymbolId;
         std::string name;
         std::string type;
     };
@@ -1,5 +1,42 @@
+#include <algorithm>
+#include <optional>
+
+#include "CsvWriter.hpp"
+#include "ThreadPool.hpp"
 #include "TradesProcessor.hpp"
 
+namespace
+{
+    bool IsStockTrade(
+        TinkoffApi::OperationType aOperationType,
+        TinkoffApi::OperationStatus aStatus,
+        TinkoffApi::InstrumentType aInstrumentType,
+        TinkoffApi::TOperationId aId,
+        bool aHasTrades)
+    {
+        const bool isAllowedType = aOperationType == TinkoffApi::OperationType::Buy
+            || aOperationType == TinkoffApi::OperationType::Sell
+            || aOperationType == TinkoffApi::OperationType::BuyCard;
+
+        return isAllowedType
+            && aStatus != TinkoffApi::OperationStatus::Decline
+            && aHasTrades
+            && aInstrumentType == TinkoffApi::InstrumentType::Stock
+            && aId != -1
+            && aId != TinkoffApi::InvalidOperationId;
+    }
+
+    bool IsStockTrade(const TinkoffApi::Operation& aOperation)
+    {
+        return IsStockTrade(
+            aOperation.operationType,
+            aOperation.status,
+            aOperation.instrumentType,
+            aOperation.numericId,
+            !aOperation.trades.empty());
+    }
+}
+
 std::vector<std::string> GetTradesTableColumns()
 {
     const std::string instrumentName = "Instrument Name";
@@ -20,25 +57,10 @@ std::vector<std::string> GetTradesTableColumns()
     };
 }
 
-std::string ShowEmpty(const std::string& aValue)
+TradesProcessor::TradesProcessor(CostMethod aCostMethod, std::size_t aThreadsCount)
+    : mCostMethod(aCostMethod)
+    , mThreadsCount(aThreadsCount)
 {
-    if (aValue.empty())
-    {
-        return "\"\"";
-    }
-    return aValue;
-}
-
-std::ostream& operator<<(std::ostream& outStream, const TradeToSave& aValue)
-{
-    const char delimiter = ';';
-    return outStream
-            << ShowEmpty(aValue.InstrumentName)
-            << delimiter << ShowEmpty(aValue.Side)
-            << delimiter << aValue.Price
-            << delimiter << aValue.Amount
-            << delimiter << ShowEmpty(aValue.Commission.currency)
-            << delimiter << aValue.Commission.value;
 }
 
 void TradesProcessor::OnMessageParsed(const TinkoffApi::MarketStocksResponse& aResponse)
@@ -46,109 +68,164 @@ void TradesProcessor::OnMessageParsed(const TinkoffApi::MarketStocksResponse& aR
     for (const auto& instrument : aResponse.instruments)
     {
         assert(!instrument.figi.empty() && !instrument.name.empty());
-        mFigiToInstrument[instrument.figi] = instrument;
+        assert(instrument.figiId != InvalidSymbolId);
+        if (instrument.figiId >= mInstruments.size())
+        {
+            mInstruments.resize(instrument.figiId + 1);
+        }
+        mInstruments[instrument.figiId] = instrument;
     }
 }
 
 void TradesProcessor::OnMessageParsed(const TinkoffApi::OperationsResponse& aResponse)
 {
-    const std::set<std::string> allowedOperationTypes
-    {
-        "Buy",
-        "Sell",
-        "BuyCard"
-    };
     for (const auto& operation : aResponse.operations)
     {
-        if (allowedOperationTypes.count(operation.operationType) == 0
-            || operation.status == "Declined"
-            || operation.trades.empty()
-            || operation.instrumentType != "Stock"
-            || operation.id == "-1")
+        if (IsStockTrade(operation))
         {
-            continue;
+            // The response is const and lives on the parser arena, so accepted operations are copied
+            ProcessOperation(TinkoffApi::Operation(operation));
         }
+    }
+    MergeOperations();
+}
 
-        for (const auto& originalTrade : operation.trades)
+void TradesProcessor::OnMessageParsed(const TinkoffApi::OperationsViewBatch& aBatch)
+{
+    // Only accepted operations are materialized, the rest never leave the batch buffer
+    for (const auto& operation : aBatch.operations)
+    {
+        if (IsStockTrade(
+                operation.operationType,
+                operation.status,
+                operation.instrumentType,
+                operation.numericId,
+                operation.tradesCount != 0))
         {
-            TradeToSave trade;
-            assert(!operation.figi.empty());
-            try
-            {
-                trade.InstrumentName = mFigiToInstrument.at(operation.figi).name;
-            }
-            catch (std::exception& ex)
-            {
-                std::cerr << "Error: " << ex.what() << std::endl;
-            }
+            ProcessOperation(aBatch.ToOperation(operation));
+        }
+    }
+    MergeOperations();
+}
+
+void TradesProcessor::OnOperationParsed(TinkoffApi::Operation&& aOperation)
+{
+    if (IsStockTrade(aOperation))
+    {
+        ProcessOperation(std::move(aOperation));
+    }
+}
 
-            trade.Price = originalTrade.price;
-            trade.Side = operation.operationType == "Sell"
-                    ? "Sell"
-                    : "Buy";
-            trade.Amount = originalTrade.quantity;
+void TradesProcessor::OnOperationsParsed()
+{
+    MergeOperations();
+}
 
-            // TODO: правильно подставлять коммиссии
-            trade.Commission = operation.commission;
-            mTrades.emplace_back(trade);
-        }
+void TradesProcessor::ProcessOperation(TinkoffApi::Operation&& aOperation)
+{
+    assert(aOperation.figiId != InvalidSymbolId);
+    if (aOperation.figiId >= mOperations.size())
+    {
+        mOperations.resize(aOperation.figiId + 1);
+    }
+    mOperations[aOperation.figiId].Append(std::move(aOperation));
+}
 
-        mOperations[operation.figi].emplace(operation);
+void TradesProcessor::MergeOperations()
+{
+    for (auto& operations : mOperations)
+    {
+        operations.Merge();
     }
 }
 
-void TradesProcessor::SaveTrades() const
+const TinkoffApi::StockInstrument* TradesProcessor::FindInstrument(TSymbolId aFigiId) const
+{
+    if (aFigiId >= mInstruments.size() || mInstruments[aFigiId].figi.empty())
+    {
+        return nullptr;
+    }
+    return &mInstruments[aFigiId];
+}
+
+void TradesProcessor::SaveTrades(const std::string& aPath) const
 {
     std::cout << "Save trades" << std::endl;
-    if (mTrades.empty())
+    const bool hasTrades = std::any_of(
+        std::begin(mOperations),
+        std::end(mOperations),
+        [](const InstrumentOperations& aOperations)
+        {
+            return !aOperations.Empty();
+        });
+
+    if (!hasTrades)
     {
         std::cerr << "SaveTrades. No trades" << std::endl;
         return;
     }
 
-    std::ofstream fileStream("/home/kostya_hm/trades.output");
-    if (fileStream.is_open())
+    CsvWriter writer;
+    if (!writer.Open(aPath))
     {
-        std::cerr << "SaveTrades. Try to save" << std::endl;
+        return;
+    }
 
-        const auto columns = GetTradesTableColumns();
-        std::copy(
-            std::begin(columns),
-            std::end(columns),
-            std::ostream_iterator<std::string>(fileStream, ";"));
+    std::cerr << "SaveTrades. Try to save" << std::endl;
+    writer.WriteRow(GetTradesTableColumns());
 
-        for (const auto& trade : mTrades)
+    std::vector<Money> commissions;
+    for (TSymbolId figiId = 0; figiId < mOperations.size(); ++figiId)
+    {
+        const auto* instrument = FindInstrument(figiId);
+        const std::string_view instrumentName = instrument
+            ? std::string_view(instrument->name)
+            : std::string_view();
+
+        for (const auto& operation : mOperations[figiId].GetOperations())
         {
-            fileStream << std::endl << trade;
+            if (!instrument)
+            {
+                std::cerr << "Error: unknown instrument " << operation.figi << std::endl;
+            }
+
+            AllocateCommission(operation, commissions);
+
+            const std::string_view side = operation.operationType == TinkoffApi::OperationType::Sell
+                ? "Sell"
+                : "Buy";
+
+            for (std::size_t index = 0; index < operation.trades.size(); ++index)
+            {
+                const auto& trade = operation.trades[index];
+
+                writer.WriteField(instrumentName);
+                writer.WriteField(side);
+                writer.WriteField(trade.price);
+                writer.WriteField(trade.quantity);
+                writer.WriteField(operation.commission.currency);
+                writer.WriteField(commissions[index]);
+                writer.EndRow();
+            }
         }
     }
 
-    fileStream.close();
+    writer.Close();
 }
 
 struct ProfitLossInfo
 {
-    std::string InstrumentName;
-    long double FinancialResult = 0.0;
-    long double Commission = 0.0;
-    long double ProfitLoss = 0.0;
-    std::string Currency;
+    /// Points into the instruments of the processor
+    std::string_view InstrumentName;
+    Money FinancialResult;
+    Money Commission;
+    Money ProfitLoss;
+    std::string_view Currency;
+    Money Unrealized;
+    Quantity OpenPosition = 0;
 };
 
-std::ostream& operator<<(std::ostream& outStream, const ProfitLossInfo& aInfo)
-{
-    return outStream
-        << std::endl
-        << aInfo.InstrumentName << ';'
-        << aInfo.FinancialResult << ';'
-        << aInfo.Commission << ';'
-        << aInfo.ProfitLoss << ';'
-        << aInfo.Currency << ';';
-}
-
-void TradesProcessor::SaveProfitLoss(
-    const std::string& aFromTime,
-    const std::string& toTime) const
+void TradesProcessor::SaveProfitLoss(const std::string& aPath) const
 {
     std::cout << "Save profit loss" << std::endl;
     if (mOperations.empty())
@@ -157,62 +234,98 @@ void TradesProcessor::SaveProfitLoss(
         return;
     }
 
-    std::ofstream fileStream("/home/kostya_hm/profit-loss"+aFromTime + "-" + toTime + ".output");
-    if (fileStream.is_open())
+    CsvWriter writer;
+    if (!writer.Open(aPath))
     {
-        std::cerr << "SaveProfitLoss. Try to save" << std::endl;
+        return;
+    }
 
-        std::vector<std::string> operations
+    std::cerr << "SaveProfitLoss. Try to save" << std::endl;
+    writer.WriteRow(
         {
             "Instrument Name",
-            "Result(without commission)",
+            "Realized result(without commission)",
             "Commission(only trades commission)",
             "Profit & Loss",
-            "Currency"
-        };
-        std::copy(
-            std::begin(operations),
-            std::end(operations),
-            std::ostream_iterator<std::string>(fileStream, ";"));
-
-        std::vector<ProfitLossInfo> profitLossInfo;
-        try
-        {
-            for (const auto& [figi, operations] : mOperations)
-            {
-                ProfitLossInfo info;
+            "Currency",
+            "Unrealized result(at last trade price)",
+            "Open Position"
+        });
 
-                const auto& instrument = mFigiToInstrument.at(figi);
-                info.InstrumentName = instrument.name;
-                info.Currency = instrument.currency;
+    // Instruments are independent, every worker matches lots with its own engine
+    // and writes into the slot of the instrument, so the output keeps the FIGI id order
+    std::vector<std::optional<ProfitLossInfo>> profitLossInfo(mOperations.size());
+    try
+    {
+        ThreadPool pool(mThreadsCount);
+        std::vector<PositionEngine> engines(pool.GetThreadsCount(), PositionEngine(mCostMethod));
 
-                for (const auto& operation : operations)
+        const std::size_t grainSize = 16;
+        pool.ParallelFor(
+            mOperations.size(),
+            grainSize,
+            [this, &engines, &profitLossInfo](std::size_t aFigiId, std::size_t aWorkerIndex)
+            {
+                const auto& operations = mOperations[aFigiId].GetOperations();
+                if (operations.empty())
                 {
-                    assert(!operation.trades.empty());
-                    if (operation.trades.empty())
-                    {
-                        std::cerr << "SaveProfitLoss. Trade operation without deals." << std::endl;
-                        continue;
-                    }
-
-                    info.FinancialResult -= operation.payment;
-                    info.Commission += std::abs(operation.commission.value);
+                    return;
                 }
+
+                const auto* instrument = FindInstrument(static_cast<TSymbolId>(aFigiId));
+                if (!instrument)
+                {
+                    return;
+                }
+
+                auto& engine = engines[aWorkerIndex];
+                engine.Reset();
+                engine.Process(operations);
+                const auto report = engine.GetReport();
+
+                ProfitLossInfo info;
+                info.InstrumentName = instrument->name;
+                info.Currency = instrument->currency;
+                info.FinancialResult = report.realizedProfitLoss;
+                info.Commission = report.commission;
                 info.ProfitLoss = info.FinancialResult - info.Commission;
+                info.Unrealized = report.unrealizedProfitLoss;
+                info.OpenPosition = report.position;
 
-                profitLossInfo.emplace_back(std::move(info));
-            }
+                profitLossInfo[aFigiId] = std::move(info);
+            });
 
-            std::copy(
-                std::begin(profitLossInfo),
-                std::end(profitLossInfo),
-                std::ostream_iterator<ProfitLossInfo>(fileStream));
+        for (TSymbolId figiId = 0; figiId < mOperations.size(); ++figiId)
+        {
+            const auto& operations = mOperations[figiId].GetOperations();
+            if (!operations.empty() && !FindInstrument(figiId))
+            {
+                std::cerr << "SaveProfitLoss. Unknown instrument "
+                    << operations.begin()->figi << std::endl;
+            }
         }
-        catch (const std::exception& ex)
+
+        for (const auto& info : profitLossInfo)
         {
-            std::cerr << "SaveProfitLoss. Error occured: " << ex.what() << std::endl;
+            if (!info)
+            {
+                continue;
+            }
+
+            writer.WriteField(info->InstrumentName);
+            writer.WriteField(info->FinancialResult);
+            writer.WriteField(info->Commission);
+            writer.WriteField(info->ProfitLoss);
+            writer.WriteField(info->Currency);
+            writer.WriteField(info->Unrealized);
+            writer.WriteField(info->OpenPosition);
+            writer.EndRow();
         }
     }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "SaveProfitLoss. Error occured: " << ex.what() << std::endl;
+    }
 
-    fileStream.close();
+    writer.Close();
 }
@@ -2,12 +2,10 @@
 
 #include <cassert>
 #include <iostream>
-#include <iterator>
-#include <fstream>
-#include <map>
-#include <set>
 
 #include "IParserHandler.hpp"
+#include "InstrumentOperations.hpp"
+#include "PositionEngine.hpp"
 #include "TinkoffApi.hpp"
 
 enum class TradeType
@@ -17,26 +15,13 @@ enum class TradeType
     ShortTrade = 2,
 };
 
-struct TradeToSave
-{
-    std::string InstrumentName;
-    std::string Side;
-
-    double Price = 0;
-    double Amount = 0;
-    TinkoffApi::Commission Commission;
-
-};
-
 std::vector<std::string> GetTradesTableColumns();
 
-std::string ShowEmpty(const std::string& aValue);
-
-std::ostream& operator<<(std::ostream& outStream, const TradeToSave& aValue);
-
 struct TradesProcessor final: IParserHandler
 {
 public:
+    /// Zero threads means std::thread::hardware_concurrency
+    explicit TradesProcessor(CostMethod aCostMethod = CostMethod::Fifo, std::size_t aThreadsCount = 0);
 
     /// IParserHandler::OnMessageParsed
     virtual void OnMessageParsed(const TinkoffApi::MarketStocksResponse& aResponse) override;
@@ -44,16 +29,37 @@ public:
     /// IParserHandler::OnMessageParsed
     virtual void OnMessageParsed(const TinkoffApi::OperationsResponse& aResponse) override;
 
-    void SaveTrades() const;
+    /// IParserHandler::OnMessageParsed
+    virtual void OnMessageParsed(const TinkoffApi::OperationsViewBatch& aBatch) override;
+
+    /// IParserHandler::OnOperationParsed
+    virtual void OnOperationParsed(TinkoffApi::Operation&& aOperation) override;
+
+    /// IParserHandler::OnOperationsParsed
+    virtual void OnOperationsParsed() override;
 
-    void SaveProfitLoss(const std::string& aFromTime, const std::string& toTime) const;
+    void SaveTrades(const std::string& aPath) const;
+
+    void SaveProfitLoss(const std::string& aPath) const;
 
     virtual ~TradesProcessor() = default;
 
 private:
-    std::map<std::string, TinkoffApi::StockInstrument> mFigiToInstrument;
-    std::vector<TradeToSave> mTrades;
+    void ProcessOperation(TinkoffApi::Operation&& aOperation);
+
+    void MergeOperations();
+
+    const TinkoffApi::StockInstrument* FindInstrument(TSymbolId aFigiId) const;
+
+    /// Indexed by the interned FIGI id, unknown ids hold an empty instrument
+    std::vector<TinkoffApi::StockInstrument> mInstruments;
+
+    /// Indexed by the interned FIGI id
+    std::vector<InstrumentOperations> mOperations;
+
+    /// Lot matching method of the realized P&L
+    CostMethod mCostMethod = CostMethod::Fifo;
 
-    using TFigi = std::string;
-    std::map<TFigi, std::set<TinkoffApi::Operation> > mOperations;
+    /// Threads of the per-instrument P&L aggregation
+    std::size_t mThreadsCount = 0;
 };
@@ -6,18 +6,28 @@ int main(int argc, char** argv)
 {
     if (argc < 2)
     {
-        std::cout << "usage: TinkoffInvest {TOKEN}";
+        std::cout << "usage: TinkoffInvest {TOKEN} [THREADS] [OUTPUT_DIRECTORY]";
         return EXIT_FAILURE;
     }
 
     std::string token = argv[1];
 
+    // Zero lets the processor use all hardware threads
+    const std::size_t threadsCount = argc > 2
+        ? std::strtoul(argv[2], nullptr, 10)
+        : 0;
+
+    const std::string outputDirectory = argc > 3
+        ? argv[3]
+        : ".";
+
     const std::string host = "api-invest.tinkoff.ru";
     const std::string port = "443";
 
-    auto processor = std::make_shared<TradesProcessor>();
+    auto processor = std::make_shared<TradesProcessor>(CostMethod::Fifo, threadsCount);
+    auto symbols = std::make_shared<SymbolTable>();
 
-    JsonParser parser(processor);
+    JsonParser parser(processor, symbols);
 
     SimpleSslHttpClient client;
 
@@ -38,12 +48,13 @@ int main(int argc, char** argv)
 
         client.SendHttpRequest(operationsRequest);
 
-        client.ProcessHttpResponse(
-            std::bind(&JsonParser::Parse, &parser, std::placeholders::_1, std::placeholders::_2),
+        client.ProcessHttpResponseStreaming(
+            std::bind(&JsonParser::ParseStream, &parser, std::placeholders::_1, std::placeholders::_2),
             TinkoffApi::ResponseType::OperationsResponse);
 
-        processor->SaveTrades();
-        processor->SaveProfitLoss(request.from, request.to);
+        processor->SaveTrades(outputDirectory + "/trades.output");
+        processor->SaveProfitLoss(
+            outputDirectory + "/profit-loss" + request.from + "-" + request.to + ".output");
     }
     catch (std::exception const& e)
     {